@@ -0,0 +1,187 @@
+#include "chat_commit.h"
+#include "chat_repository.h"
+#include "db.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static struct {
+    pthread_mutex_t    mtx;
+    pthread_cond_t     cv;          /* CLOCK_MONOTONIC */
+    chat_commit_req_t *head, *tail;
+    size_t             n;
+    struct timespec    first;       /* 대기 중 가장 먼저 온 요청 시각 */
+    int                stopping;
+    int                started;
+    pthread_t          tid;
+    size_t             batch_max;
+    long               window_us;
+    chat_commit_stats_t st;
+} cc = {
+    .mtx = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* 커밋 스레드 전용 배치 버퍼 */
+static chat_commit_req_t  *batch_req[CHAT_COMMIT_BATCH_MAX];
+static chat_new_message_t  batch_row[CHAT_COMMIT_BATCH_MAX];
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000;
+}
+
+static int hist_bucket(size_t n) {
+    int b = 0;
+    while (n > 1 && b + 1 < CHAT_COMMIT_HIST) {
+        n >>= 1;
+        b++;
+    }
+    return b;
+}
+
+/* 배치 저장. 문장 단계에서 실패했으면(롤백됨) 한 건씩 다시 넣어
+ * 문제 있는 메시지 하나 때문에 나머지까지 잃지 않게 한다 */
+static int commit_batch(size_t n, unsigned long *failed) {
+    int rc = chat_repo_save_messages(batch_row, n);
+    for (size_t i = 0; i < n; i++) batch_req[i]->rc = rc;
+    *failed = 0;
+    if (rc == -2 && n > 1) {
+        for (size_t i = 0; i < n; i++) {
+            batch_req[i]->rc = chat_repo_save_messages(&batch_row[i], 1);
+            if (batch_req[i]->rc != 0) (*failed)++;
+        }
+        return 1;
+    }
+    if (rc != 0) *failed = n;
+    return 0;
+}
+
+static void *commit_main(void *arg) {
+    (void) arg;
+    if (db_thread_init() != 0) {
+        fprintf(stderr, "ERROR: db_thread_init failed (commit)\n");
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_mutex_lock(&cc.mtx);
+    for (;;) {
+        while (!cc.head && !cc.stopping) {
+            pthread_cond_wait(&cc.cv, &cc.mtx);
+        }
+        if (!cc.head) break;                  // stopping && 큐 비었음
+
+        // 배치가 차거나 첫 요청 후 window 가 지날 때까지 더 모음
+        struct timespec deadline = cc.first;
+        deadline.tv_sec  += cc.window_us / 1000000;
+        deadline.tv_nsec += (cc.window_us % 1000000) * 1000;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (cc.n < cc.batch_max && !cc.stopping) {
+            if (pthread_cond_timedwait(&cc.cv, &cc.mtx, &deadline) == ETIMEDOUT) break;
+        }
+
+        size_t n = 0;
+        while (cc.head && n < cc.batch_max) {
+            chat_commit_req_t *r = cc.head;
+            cc.head = r->next;
+            batch_req[n] = r;
+            batch_row[n] = (chat_new_message_t) {
+                .room_id   = r->room_id,
+                .sender_id = r->sender_id,
+                .content   = r->content,
+                .len       = r->len,
+            };
+            n++;
+        }
+        if (!cc.head) cc.tail = NULL;
+        cc.n -= n;
+        // 남은 요청은 이번 커밋 동안 기다렸으니 지금부터 window 를 잰다
+        if (cc.head) clock_gettime(CLOCK_MONOTONIC, &cc.first);
+        pthread_mutex_unlock(&cc.mtx);
+
+        uint64_t t0 = now_us();
+        unsigned long failed;
+        int retried = commit_batch(n, &failed);
+        uint64_t dt = now_us() - t0;
+
+        for (size_t i = 0; i < n; i++) {
+            chat_commit_req_t *r = batch_req[i];
+            r->message_id = r->rc == 0 ? batch_row[i].id : 0;
+            r->done(r);
+        }
+
+        pthread_mutex_lock(&cc.mtx);
+        cc.st.batches++;
+        cc.st.messages  += n;
+        cc.st.failed    += failed;
+        cc.st.retried   += (unsigned long) retried;
+        cc.st.commit_us += dt;
+        cc.st.hist[hist_bucket(n)]++;
+        if (n > cc.st.max_batch) cc.st.max_batch = n;
+    }
+    pthread_mutex_unlock(&cc.mtx);
+
+    db_thread_cleanup();
+    return NULL;
+}
+
+int chat_commit_start(size_t batch_max, long window_us) {
+    if (batch_max < 1)                     batch_max = 1;
+    if (batch_max > CHAT_COMMIT_BATCH_MAX) batch_max = CHAT_COMMIT_BATCH_MAX;
+    if (window_us < 0)                     window_us = 0;
+    cc.batch_max = batch_max;
+    cc.window_us = window_us;
+
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&cc.cv, &ca);
+    pthread_condattr_destroy(&ca);
+
+    if (pthread_create(&cc.tid, NULL, commit_main, NULL) != 0) {
+        pthread_cond_destroy(&cc.cv);
+        return -1;
+    }
+    cc.started = 1;
+    return 0;
+}
+
+void chat_commit_stop(void) {
+    if (!cc.started) return;
+    pthread_mutex_lock(&cc.mtx);
+    cc.stopping = 1;
+    pthread_cond_signal(&cc.cv);
+    pthread_mutex_unlock(&cc.mtx);
+
+    pthread_join(cc.tid, NULL);
+    pthread_cond_destroy(&cc.cv);
+    cc.started = 0;
+}
+
+void chat_commit_submit(chat_commit_req_t *req) {
+    req->next = NULL;
+    pthread_mutex_lock(&cc.mtx);
+    if (cc.tail) cc.tail->next = req;
+    else         cc.head = req;
+    cc.tail = req;
+    cc.n++;
+    // 빈 큐에 첫 요청: window 시작. 배치가 차면 바로 깨움
+    if (cc.n == 1) {
+        clock_gettime(CLOCK_MONOTONIC, &cc.first);
+        pthread_cond_signal(&cc.cv);
+    } else if (cc.n == cc.batch_max) {
+        pthread_cond_signal(&cc.cv);
+    }
+    pthread_mutex_unlock(&cc.mtx);
+}
+
+void chat_commit_stats(chat_commit_stats_t *out) {
+    pthread_mutex_lock(&cc.mtx);
+    *out = cc.st;
+    pthread_mutex_unlock(&cc.mtx);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------- 메시지 그룹 커밋 ----------
+ * 채팅 메시지 INSERT 를 모아 한 트랜잭션의 멀티로우 INSERT 로 저장한다.
+ * 첫 요청이 들어온 뒤 window_us 가 지나거나 batch_max 개가 차면 커밋하고,
+ * 요청마다 자기 message_id 와 결과를 채워 done() 을 부른다.
+ * 전용 스레드 하나가 자기 DB 커넥션으로 처리 (db_pool 과 별개). */
+
+#define CHAT_COMMIT_BATCH_MAX 512   /* batch_max 상한 */
+#define CHAT_COMMIT_HIST      10    /* 배치 크기 분포: 1, 2-3, 4-7, ..., 512 */
+
+typedef struct chat_commit_req chat_commit_req_t;
+typedef void (*chat_commit_fn)(chat_commit_req_t *req);
+
+struct chat_commit_req {
+    uint32_t                room_id;
+    uint32_t                sender_id;
+    const char             *content;     /* done() 까지 유지 */
+    size_t                  len;
+    uint32_t                message_id;  /* 결과: 저장된 id */
+    int                     rc;          /* 결과: 0 성공 */
+    chat_commit_fn          done;        /* 커밋 스레드에서 호출 (오래 잡지 말 것) */
+    struct chat_commit_req *next;
+};
+
+typedef struct {
+    unsigned long batches, messages;
+    unsigned long failed;      /* 실패한 메시지 수 */
+    unsigned long retried;     /* 배치 실패 후 한 건씩 다시 넣은 배치 수 */
+    size_t        max_batch;
+    unsigned long hist[CHAT_COMMIT_HIST];
+    uint64_t      commit_us;   /* 배치 저장(INSERT + COMMIT) 누적 시간 */
+} chat_commit_stats_t;
+
+/* batch_max: 배치 최대 크기 (1..CHAT_COMMIT_BATCH_MAX), window_us: 첫 요청 후 최대 대기.
+ * 0 성공 */
+int  chat_commit_start(size_t batch_max, long window_us);
+/* 남은 요청을 모두 커밋한 뒤 스레드 종료 */
+void chat_commit_stop(void);
+
+void chat_commit_submit(chat_commit_req_t *req);
+
+void chat_commit_stats(chat_commit_stats_t *out);
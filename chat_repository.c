@@ -3,6 +3,8 @@
 #include <stdio.h>
 
 #include "db.h"
+#include "chat_unread_cache.h"
+#include "room_member_cache.h"
 #include <mysql/mysql.h>
 #include <stdlib.h>
 #include <string.h>
@@ -52,115 +54,246 @@ int chat_repo_find_public_rooms(chat_room_t **out_rooms, size_t *out_count) {
     return fetch_rooms(res, out_rooms, out_count, 0, 0);
 }
 
-/* ── 채팅방 참여 / 탈퇴 ── */
-int chat_repo_join_room(uint32_t room_id, uint32_t user_id) {
-    MYSQL *db = get_db();
-    if (!db) return -1;
+/* ── 바인딩 헬퍼 ── */
+static void bind_u32(MYSQL_BIND *b, uint32_t *v) {
+    memset(b, 0, sizeof *b);
+    b->buffer_type = MYSQL_TYPE_LONG;
+    b->buffer      = v;
+    b->is_unsigned = 1;
+}
 
-    MYSQL_STMT *st = mysql_stmt_init(db);
-    const char *sql =
-            "INSERT IGNORE INTO chat_room_member(room_id,user_id) VALUES(?,?)";
-    mysql_stmt_prepare(st, sql, strlen(sql));
-    MYSQL_BIND pb[2] = {{0}}, ub[2] = {{0}};
-    pb[0].buffer_type = MYSQL_TYPE_LONG;
-    pb[0].buffer = &room_id;
-    pb[1].buffer_type = MYSQL_TYPE_LONG;
-    pb[1].buffer = &user_id;
-    mysql_stmt_bind_param(st, pb);
-    if (mysql_stmt_execute(st)) {
-        mysql_stmt_close(st);
-        return -2;
-    }
-    mysql_stmt_close(st);
+/* 파라미터만 있고 결과 없는 문장 */
+static int exec_update(db_stmt_id id, MYSQL_BIND *pb) {
+    MYSQL_STMT *st = db_stmt_exec(id, pb);
+    if (!st) return -2;
+    db_stmt_done(st);
     return 0;
 }
 
-int chat_repo_leave_room(uint32_t room_id, uint32_t user_id) {
-    MYSQL *db = get_db();
-    if (!db) return -1;
-    MYSQL_STMT *st = mysql_stmt_init(db);
-    const char *sql =
-            "DELETE FROM chat_room_member WHERE room_id=? AND user_id=?";
-    mysql_stmt_prepare(st, sql, strlen(sql));
-    MYSQL_BIND pb[2] = {{0}};
-    pb[0].buffer_type = MYSQL_TYPE_LONG;
-    pb[0].buffer = &room_id;
-    pb[1].buffer_type = MYSQL_TYPE_LONG;
-    pb[1].buffer = &user_id;
-    mysql_stmt_bind_param(st, pb);
-    if (mysql_stmt_execute(st)) {
-        mysql_stmt_close(st);
+/* 결과가 u32 한 칸인 문장 (COUNT 등). 행이 없으면 0 */
+static int exec_u32(db_stmt_id id, MYSQL_BIND *pb, uint32_t *out) {
+    MYSQL_STMT *st = db_stmt_exec(id, pb);
+    if (!st) return -2;
+
+    uint32_t v = 0;
+    MYSQL_BIND rb;
+    bind_u32(&rb, &v);
+    int rc = 0;
+    if (mysql_stmt_bind_result(st, &rb)) {
+        rc = -2;
+    } else {
+        int fs = mysql_stmt_fetch(st);
+        if (fs == MYSQL_NO_DATA) v = 0;
+        else if (fs != 0 && fs != MYSQL_DATA_TRUNCATED) rc = -2;
+    }
+    db_stmt_done(st);
+    if (rc == 0) *out = v;
+    return rc;
+}
+
+/* 결과가 (u32, u32) 행들인 문장 → chat_unread_t 배열 */
+static int exec_unread_rows(db_stmt_id id, MYSQL_BIND *pb, chat_unread_t **out, size_t *cnt) {
+    MYSQL_STMT *st = db_stmt_exec(id, pb);
+    if (!st) return -2;
+
+    uint32_t mid = 0, c = 0;
+    MYSQL_BIND rb[2];
+    bind_u32(&rb[0], &mid);
+    bind_u32(&rb[1], &c);
+    if (mysql_stmt_bind_result(st, rb) || mysql_stmt_store_result(st)) {
+        db_stmt_done(st);
         return -2;
     }
-    mysql_stmt_close(st);
+
+    size_t n = (size_t) mysql_stmt_num_rows(st);
+    chat_unread_t *arr = NULL;
+    if (n > 0 && !(arr = calloc(n, sizeof *arr))) {
+        db_stmt_done(st);
+        return -1;
+    }
+
+    size_t idx = 0;
+    while (idx < n && mysql_stmt_fetch(st) == 0) {
+        arr[idx].message_id = mid;
+        arr[idx].count      = c;
+        idx++;
+    }
+    db_stmt_done(st);
+
+    *out = arr;
+    *cnt = idx;
     return 0;
 }
 
+/* ── 채팅방 참여 / 탈퇴 ── */
+int chat_repo_join_room(uint32_t room_id, uint32_t user_id) {
+    MYSQL_BIND pb[2];
+    bind_u32(&pb[0], &room_id);
+    bind_u32(&pb[1], &user_id);
+    int rc = exec_update(DB_STMT_ROOM_JOIN, pb);
+    if (rc == 0) room_members_add(room_id, user_id);
+    return rc;
+}
+
+int chat_repo_leave_room(uint32_t room_id, uint32_t user_id) {
+    MYSQL_BIND pb[2];
+    bind_u32(&pb[0], &room_id);
+    bind_u32(&pb[1], &user_id);
+    int rc = exec_update(DB_STMT_ROOM_LEAVE, pb);
+    if (rc == 0) room_members_remove(room_id, user_id);
+    return rc;
+}
+
 /* ── 메시지 저장 ── */
 int chat_repo_save_message(uint32_t room_id, uint32_t sender_id,
                            const char *content, uint32_t *out_message_id) {
-    MYSQL *db = get_db();
-    if (!db) return -1;
-    MYSQL_STMT *st = mysql_stmt_init(db);
-    const char *sql =
-            "INSERT INTO chat_message(room_id,sender_id,content) VALUES(?,?,?)";
-    mysql_stmt_prepare(st, sql, strlen(sql));
-    MYSQL_BIND pb[3] = {{0}};
-    pb[0].buffer_type = MYSQL_TYPE_LONG;
-    pb[0].buffer = &room_id;
-    pb[1].buffer_type = MYSQL_TYPE_LONG;
-    pb[1].buffer = &sender_id;
+    MYSQL_BIND pb[3];
+    bind_u32(&pb[0], &room_id);
+    bind_u32(&pb[1], &sender_id);
+    memset(&pb[2], 0, sizeof pb[2]);
     pb[2].buffer_type = MYSQL_TYPE_STRING;
     pb[2].buffer = (char *) content;
     pb[2].buffer_length = strlen(content);
-    mysql_stmt_bind_param(st, pb);
-    if (mysql_stmt_execute(st)) {
-        mysql_stmt_close(st);
-        return -2;
-    }
+
+    MYSQL_STMT *st = db_stmt_exec(DB_STMT_MSG_SAVE, pb);
+    if (!st) return -2;
     *out_message_id = (uint32_t) mysql_stmt_insert_id(st);
-    mysql_stmt_close(st);
+    db_stmt_done(st);
     return 0;
 }
 
+/* 메시지 여러 개를 한 트랜잭션으로: 64행 / 8행 / 1행 문장으로 정확히 나눠 넣는다.
+ * 행 수가 정해진 단순 INSERT 는 auto-increment 값을 한 번에 연속으로 받으므로
+ * 각 행 id = 첫 id + k * @@auto_increment_increment */
+static const struct { db_stmt_id id; size_t rows; } msg_tiers[] = {
+    { DB_STMT_MSG_SAVE_64, 64 },
+    { DB_STMT_MSG_SAVE_8,  8  },
+    { DB_STMT_MSG_SAVE,    1  },
+};
+#define MSG_TIERS    (sizeof msg_tiers / sizeof msg_tiers[0])
+#define MSG_ROWS_MAX 64
+
+int chat_repo_save_messages(chat_new_message_t *msgs, size_t n) {
+    if (n == 0) return 0;
+
+    static __thread MYSQL_BIND pb[3 * MSG_ROWS_MAX];
+
+    // 커넥션이 없으면 db_begin 이 재접속을 시도. 실패해도 실행된 것이 없으니 -2
+    if (db_begin() != 0) return -2;
+    unsigned step = db_autoinc_step();
+
+    for (size_t i = 0, t = 0; i < n; ) {
+        while (msg_tiers[t].rows > n - i) t++;
+        size_t rows = msg_tiers[t].rows;
+
+        for (size_t k = 0; k < rows; k++) {
+            chat_new_message_t *m = &msgs[i + k];
+            bind_u32(&pb[3 * k],     &m->room_id);
+            bind_u32(&pb[3 * k + 1], &m->sender_id);
+            memset(&pb[3 * k + 2], 0, sizeof pb[3 * k + 2]);
+            pb[3 * k + 2].buffer_type   = MYSQL_TYPE_STRING;
+            pb[3 * k + 2].buffer        = (char *) m->content;
+            pb[3 * k + 2].buffer_length = m->len;
+        }
+        MYSQL_STMT *st = db_stmt_exec(msg_tiers[t].id, pb);
+        if (!st) goto fail;
+        uint64_t first = mysql_stmt_insert_id(st);
+        unsigned long long added = mysql_stmt_affected_rows(st);
+        db_stmt_done(st);
+        if (added != rows || first == 0) {
+            fprintf(stderr, "ERROR: chat_repo_save_messages inserted %llu/%zu rows\n", added, rows);
+            goto fail;
+        }
+        for (size_t k = 0; k < rows; k++) {
+            msgs[i + k].id = (uint32_t) (first + k * step);
+        }
+        i += rows;
+    }
+
+    // 커밋 실패는 반영 여부를 알 수 없어 재시도하면 안 됨
+    return db_commit() == 0 ? 0 : -3;
+
+fail:
+    db_rollback();
+    return -2;
+}
+
 /* ── Unread ── */
 int chat_repo_add_unread(uint32_t message_id, uint32_t user_id) {
-    MYSQL *db = get_db();
-    if (!db) return -1;
-    char sql[128];
-    snprintf(sql, sizeof sql,
-             "INSERT IGNORE INTO chat_message_unread(message_id,user_id) VALUES(%u,%u)",
-             message_id, user_id);
-    return mysql_query(db, sql) ? -2 : 0;
+    MYSQL_BIND pb[2];
+    bind_u32(&pb[0], &message_id);
+    bind_u32(&pb[1], &user_id);
+    MYSQL_STMT *st = db_stmt_exec(DB_STMT_UNREAD_ADD, pb);
+    if (!st) return -2;
+    unsigned long long added = mysql_stmt_affected_rows(st);
+    db_stmt_done(st);
+
+    if (added > 0) {
+        // 메시지가 속한 방을 알아야 캐시를 갱신할 수 있음
+        uint32_t room_id;
+        MYSQL_BIND mb;
+        bind_u32(&mb, &message_id);
+        if (exec_u32(DB_STMT_MSG_ROOM, &mb, &room_id) == 0) chat_unread_cache_add(room_id, &user_id, 1);
+    }
+    return 0;
+}
+
+/* 멀티로우 INSERT 문 크기: 남은 행 수를 덮는 가장 작은 문장을 쓰고,
+ * 빈 자리는 마지막 사용자로 채운다 (INSERT IGNORE 라 중복은 무시됨) */
+static const struct { db_stmt_id id; size_t rows; } unread_tiers[] = {
+    { DB_STMT_UNREAD_ADD_8,   8   },
+    { DB_STMT_UNREAD_ADD_64,  64  },
+    { DB_STMT_UNREAD_ADD_512, 512 },
+};
+#define UNREAD_TIERS    (sizeof unread_tiers / sizeof unread_tiers[0])
+#define UNREAD_ROWS_MAX 512
+
+int chat_repo_add_unread_bulk(uint32_t room_id, uint32_t message_id, const uint32_t *user_ids, size_t n) {
+    if (n == 0) return 0;
+
+    // 스레드별 재사용 바인딩 버퍼
+    static __thread MYSQL_BIND pb[2 * UNREAD_ROWS_MAX];
+    static __thread uint32_t   uids[UNREAD_ROWS_MAX];
+    static __thread uint32_t   mid;
+
+    mid = message_id;
+    for (size_t i = 0; i < n; ) {
+        size_t left = n - i, t = 0;
+        while (t + 1 < UNREAD_TIERS && unread_tiers[t].rows < left) t++;
+        size_t rows = unread_tiers[t].rows;
+        size_t take = left < rows ? left : rows;
+
+        for (size_t k = 0; k < rows; k++) {
+            uids[k] = user_ids[i + (k < take ? k : take - 1)];
+            bind_u32(&pb[2 * k],     &mid);
+            bind_u32(&pb[2 * k + 1], &uids[k]);
+        }
+        MYSQL_STMT *st = db_stmt_exec(unread_tiers[t].id, pb);
+        if (!st) return -2;
+        db_stmt_done(st);
+
+        // 덩어리마다 autocommit 이라 성공한 만큼 바로 캐시에 반영 (뒤 덩어리가 실패해도 맞게)
+        // 새 메시지라 행은 모두 새로 들어간 것: 사용자마다 +1
+        chat_unread_cache_add(room_id, user_ids + i, take);
+        i += take;
+    }
+    return 0;
 }
 
 int chat_repo_clear_unread(uint32_t room_id, uint32_t user_id) {
-    MYSQL *db = get_db();
-    if (!db) return -1;
-    char sql[256];
-    snprintf(sql, sizeof sql,
-             "DELETE u FROM chat_message_unread u "
-             "JOIN chat_message m ON m.id=u.message_id "
-             "WHERE m.room_id=%u AND u.user_id=%u",
-             room_id, user_id);
-    return mysql_query(db, sql) ? -2 : 0;
+    MYSQL_BIND pb[2];
+    bind_u32(&pb[0], &room_id);
+    bind_u32(&pb[1], &user_id);
+    int rc = exec_update(DB_STMT_UNREAD_CLEAR, pb);
+    if (rc == 0) chat_unread_cache_clear(room_id, user_id);
+    return rc;
 }
 
 int chat_repo_count_unread(uint32_t room_id, uint32_t user_id, uint32_t *out_count) {
-    MYSQL *db = get_db();
-    if (!db) return -1;
-    char sql[256];
-    snprintf(sql, sizeof sql,
-             "SELECT COUNT(*) FROM chat_message_unread u "
-             "JOIN chat_message m ON m.id=u.message_id "
-             "WHERE m.room_id=%u AND u.user_id=%u",
-             room_id, user_id);
-    if (mysql_query(db, sql)) return -2;
-    MYSQL_RES *res = mysql_store_result(db);
-    MYSQL_ROW row = mysql_fetch_row(res);
-    *out_count = row ? (uint32_t) atoi(row[0]) : 0;
-    mysql_free_result(res);
-    return 0;
+    MYSQL_BIND pb[2];
+    bind_u32(&pb[0], &room_id);
+    bind_u32(&pb[1], &user_id);
+    return exec_u32(DB_STMT_UNREAD_COUNT, pb, out_count);
 }
 
 /* ---------- 채팅방 멤버 조회 구현 ---------- */
@@ -168,46 +301,36 @@ int chat_repo_get_room_members(uint32_t room_id,
                                uint32_t **out_user_ids,
                                size_t   *out_count)
 {
-    MYSQL *db = get_db();
-    if (!db) return -1;
+    // — 파라미터 바인딩 & 실행
+    MYSQL_BIND param;
+    bind_u32(&param, &room_id);
+    MYSQL_STMT *st = db_stmt_exec(DB_STMT_ROOM_MEMBERS, &param);
+    if (!st) return -2;
 
-    MYSQL_STMT *st = mysql_stmt_init(db);
-    const char *sql =
-      "SELECT user_id FROM chat_room_member WHERE room_id = ?";
-    mysql_stmt_prepare(st, sql, strlen(sql));
-
-    // — 파라미터 바인딩
-    MYSQL_BIND param = {0};
-    param.buffer_type = MYSQL_TYPE_LONG;
-    param.buffer      = &room_id;
-    mysql_stmt_bind_param(st, &param);
-    mysql_stmt_execute(st);
-
-    // — 결과 버퍼링 & 행 수 확보
-    mysql_stmt_store_result(st);
-    size_t n = mysql_stmt_num_rows(st);
-    uint32_t *ids = calloc(n, sizeof(uint32_t));
-
-    // — 결과 바인딩 (임시 변수 사용)
+    // — 결과 바인딩 (임시 변수 사용), 버퍼링 & 행 수 확보
     uint32_t tmp = 0;
-    MYSQL_BIND result = {0};
-    result.buffer_type   = MYSQL_TYPE_LONG;
-    result.buffer        = &tmp;
-    result.buffer_length = sizeof(tmp);
-    result.is_null       = 0;
-    result.length        = 0;
-    mysql_stmt_bind_result(st, &result);
+    MYSQL_BIND result;
+    bind_u32(&result, &tmp);
+    if (mysql_stmt_bind_result(st, &result) || mysql_stmt_store_result(st)) {
+        db_stmt_done(st);
+        return -2;
+    }
+    size_t n = mysql_stmt_num_rows(st);
+    uint32_t *ids = calloc(n ? n : 1, sizeof(uint32_t));
+    if (!ids) {
+        db_stmt_done(st);
+        return -1;
+    }
 
     // — fetch 루프
     size_t idx = 0;
     while (idx < n && mysql_stmt_fetch(st) == 0) {
         ids[idx++] = tmp;
     }
-
-    mysql_stmt_close(st);
+    db_stmt_done(st);
 
     *out_user_ids = ids;
-    *out_count    = idx;  // 혹시 실제 읽은 행 수(idx)가 n보다 작으면 그 값으로…
+    *out_count    = idx;
     return 0;
 }
 
@@ -217,52 +340,16 @@ int chat_repo_get_unread_counts(
     chat_unread_t **out_array,
     size_t *out_count
 ) {
-    MYSQL *db = get_db();
-    if (!db) return -1;
-
-    char sql[256];
-    snprintf(sql, sizeof sql,
-        "SELECT m.id, COUNT(u.user_id) "
-        "FROM chat_message m "
-        "LEFT JOIN chat_message_unread u ON u.message_id=m.id "
-        "WHERE m.room_id=%u "
-        "GROUP BY m.id",
-        room_id);
-
-    if (mysql_query(db, sql)) return -2;
-    MYSQL_RES *res = mysql_store_result(db);
-    size_t n = mysql_num_rows(res);
-
-    chat_unread_t *arr = calloc(n, sizeof(chat_unread_t));
-    MYSQL_ROW row;
-    size_t i = 0;
-    while ((row = mysql_fetch_row(res))) {
-        arr[i].message_id = (uint32_t)atoi(row[0]);
-        arr[i].count      = (uint32_t)atoi(row[1]);
-        i++;
-    }
-    mysql_free_result(res);
-    *out_array  = arr;
-    *out_count  = n;
-    return 0;
+    MYSQL_BIND pb;
+    bind_u32(&pb, &room_id);
+    return exec_unread_rows(DB_STMT_UNREAD_BY_ROOM, &pb, out_array, out_count);
 }
 
 /* ── 메시지별 전체 언리드 카운트 ── */
 int chat_repo_count_message_unread(uint32_t message_id, uint32_t *out_count) {
-    MYSQL *db = get_db();
-    if (!db) return -1;
-
-    char sql[128];
-    snprintf(sql, sizeof sql,
-        "SELECT COUNT(*) FROM chat_message_unread WHERE message_id=%u",
-        message_id);
-
-    if (mysql_query(db, sql)) return -2;
-    MYSQL_RES *res = mysql_store_result(db);
-    MYSQL_ROW row = mysql_fetch_row(res);
-    *out_count = row ? (uint32_t)atoi(row[0]) : 0;
-    mysql_free_result(res);
-    return 0;
+    MYSQL_BIND pb;
+    bind_u32(&pb, &message_id);
+    return exec_u32(DB_STMT_MSG_UNREAD_COUNT, &pb, out_count);
 }
 
 int chat_repo_get_unread_counts_for_user(uint32_t room_id,
@@ -270,163 +357,32 @@ int chat_repo_get_unread_counts_for_user(uint32_t room_id,
                                          chat_unread_t **out_unreads,
                                          size_t       *out_count)
 {
-    MYSQL     *db = get_db();
-    if (!db) return -1;
-
-    MYSQL_STMT *st = mysql_stmt_init(db);
-    if (!st) return -1;
-
-    const char *sql =
-        "SELECT u.message_id, COUNT(*) AS cnt "
-        "  FROM chat_message_unread AS u "
-        "  JOIN chat_message        AS m "
-        "    ON m.id = u.message_id "
-        " WHERE m.room_id  = ? "
-        "   AND u.user_id  = ? "
-        " GROUP BY u.message_id";
-
-    if (mysql_stmt_prepare(st, sql, (unsigned long)strlen(sql)) != 0) {
-        mysql_stmt_close(st);
-        return -1;
-    }
-
-    /* --- 파라미터 바인딩(room_id, user_id) --- */
-    MYSQL_BIND param[2];
-    memset(param, 0, sizeof(param));
-
-    param[0].buffer_type   = MYSQL_TYPE_LONG;
-    param[0].buffer        = &room_id;
-    param[0].is_null       = 0;
-    param[0].length        = 0;
-
-    param[1].buffer_type   = MYSQL_TYPE_LONG;
-    param[1].buffer        = &user_id;
-    param[1].is_null       = 0;
-    param[1].length        = 0;
-
-    if (mysql_stmt_bind_param(st, param) != 0) {
-        mysql_stmt_close(st);
-        return -1;
-    }
-
-    if (mysql_stmt_execute(st) != 0) {
-        mysql_stmt_close(st);
-        return -1;
-    }
-
-    /* --- 결과 메타데이터 준비 & 전체 행 수 조회 --- */
-    mysql_stmt_store_result(st);
-    size_t n = (size_t)mysql_stmt_num_rows(st);
-    if (n == 0) {
-        /* 읽지 않은 메시지가 없으면 빈 배열 반환 */
-        *out_unreads = NULL;
-        *out_count   = 0;
-        mysql_stmt_close(st);
-        return 0;
-    }
-
-    /* 메모리 할당 */
-    chat_unread_t *arr = calloc(n, sizeof(chat_unread_t));
-    if (!arr) {
-        mysql_stmt_close(st);
-        return -1;
-    }
-
-    /* --- 결과 바인딩(message_id, cnt) --- */
-    uint32_t tmp_mid;
-    uint32_t tmp_cnt;
-    MYSQL_BIND result[2];
-    memset(result, 0, sizeof(result));
-
-    result[0].buffer_type   = MYSQL_TYPE_LONG;
-    result[0].buffer        = &tmp_mid;
-    result[0].is_null       = 0;
-    result[0].length        = 0;
-
-    result[1].buffer_type   = MYSQL_TYPE_LONG;
-    result[1].buffer        = &tmp_cnt;
-    result[1].is_null       = 0;
-    result[1].length        = 0;
-
-    if (mysql_stmt_bind_result(st, result) != 0) {
-        free(arr);
-        mysql_stmt_close(st);
-        return -1;
-    }
-
-    /* --- fetch 루프 --- */
-    size_t idx = 0;
-    while (idx < n && mysql_stmt_fetch(st) == 0) {
-        arr[idx].message_id = tmp_mid;
-        arr[idx].count      = tmp_cnt;
-        idx++;
-    }
-
-    mysql_stmt_close(st);
-
-    *out_unreads = arr;
-    *out_count   = idx; // 실제 읽어온 행 개수
-    return 0;
+    /* 읽지 않은 메시지가 없으면 빈 배열(NULL, 0) 반환 */
+    MYSQL_BIND pb[2];
+    bind_u32(&pb[0], &room_id);
+    bind_u32(&pb[1], &user_id);
+    return exec_unread_rows(DB_STMT_UNREAD_FOR_USER, pb, out_unreads, out_count) ? -1 : 0;
 }
 
 int chat_repo_get_unread_count_for_message(uint32_t room_id,
                                            uint32_t message_id)
 {
-    MYSQL      *db = get_db();
-    if (!db) return -1;
-
-    MYSQL_STMT *st = mysql_stmt_init(db);
-    if (!st) return -1;
-
     // chat_message_unread 테이블과 chat_message 테이블을 조인해서 room_id로 필터링
-    const char *sql =
-        "SELECT COUNT(*) "
-        "  FROM chat_message_unread AS u "
-        "  JOIN chat_message        AS m "
-        "    ON m.id = u.message_id "
-        " WHERE m.room_id    = ? "
-        "   AND u.message_id = ?";
-
-    if (mysql_stmt_prepare(st, sql, (unsigned long)strlen(sql)) != 0) {
-        mysql_stmt_close(st);
-        return -1;
-    }
-
-    // 파라미터 바인딩(room_id, message_id)
-    MYSQL_BIND params[2];
-    memset(params, 0, sizeof(params));
-    params[0].buffer_type = MYSQL_TYPE_LONG;
-    params[0].buffer      = &room_id;
-    params[1].buffer_type = MYSQL_TYPE_LONG;
-    params[1].buffer      = &message_id;
-
-    if (mysql_stmt_bind_param(st, params) != 0) {
-        mysql_stmt_close(st);
-        return -1;
-    }
-    if (mysql_stmt_execute(st) != 0) {
-        mysql_stmt_close(st);
-        return -1;
-    }
-
-    // 결과 바인딩
     uint32_t cnt = 0;
-    MYSQL_BIND result;
-    memset(&result, 0, sizeof(result));
-    result.buffer_type = MYSQL_TYPE_LONG;
-    result.buffer      = &cnt;
-
-    if (mysql_stmt_bind_result(st, &result) != 0) {
-        mysql_stmt_close(st);
-        return -1;
-    }
-
-    // fetch 해서 cnt 채우기
-    if (mysql_stmt_fetch(st) != 0) {
-        mysql_stmt_close(st);
-        return -1;
-    }
-
-    mysql_stmt_close(st);
+    MYSQL_BIND pb[2];
+    bind_u32(&pb[0], &room_id);
+    bind_u32(&pb[1], &message_id);
+    if (exec_u32(DB_STMT_UNREAD_FOR_MSG, pb, &cnt) != 0) return -1;
     return (int)cnt;
 }
+
+int chat_repo_get_read_receipts(uint32_t room_id,
+                                uint32_t user_id,
+                                chat_unread_t **out_receipts,
+                                size_t       *out_count)
+{
+    MYSQL_BIND pb[2];
+    bind_u32(&pb[0], &room_id);
+    bind_u32(&pb[1], &user_id);
+    return exec_unread_rows(DB_STMT_UNREAD_RECEIPTS, pb, out_receipts, out_count) ? -1 : 0;
+}
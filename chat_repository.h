@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include <time.h>
 
@@ -48,6 +49,20 @@ int chat_repo_save_message(
     uint32_t *out_message_id
 );
 
+/* 그룹 커밋용 새 메시지 한 행. id 는 저장 후 채워짐 */
+typedef struct {
+    uint32_t    room_id;
+    uint32_t    sender_id;
+    const char *content;
+    size_t      len;
+    uint32_t    id;
+} chat_new_message_t;
+
+/* n 개를 한 트랜잭션의 멀티로우 INSERT 로 저장하고 각 id 를 채운다.
+ * 0 성공, -2 문장 실패 (롤백됨, 다시 넣어도 안전),
+ * -3 커밋 실패 (반영 여부 불명) */
+int chat_repo_save_messages(chat_new_message_t *msgs, size_t n);
+
 int chat_repo_get_messages(
     uint32_t room_id,
     uint32_t page,
@@ -58,6 +73,10 @@ int chat_repo_get_messages(
 
 /* ── Unread 관리 ── */
 int chat_repo_add_unread(uint32_t message_id, uint32_t user_id);
+/* 여러 사용자 한꺼번에: 멀티로우 INSERT IGNORE, 길면 여러 문장으로 분할.
+ * room_id 는 message_id 가 속한 방 (unread 캐시 갱신용) */
+int chat_repo_add_unread_bulk(uint32_t room_id, uint32_t message_id,
+                              const uint32_t *user_ids, size_t n);
 int chat_repo_clear_unread(uint32_t room_id, uint32_t user_id);
 int chat_repo_count_unread(uint32_t room_id, uint32_t user_id, uint32_t *out_count);
 
@@ -84,4 +103,12 @@ int chat_repo_get_unread_counts_for_user(uint32_t room_id,
                                          size_t       *out_count);
 
 int chat_repo_get_unread_count_for_message(uint32_t room_id,
-                                           uint32_t message_id);
\ No newline at end of file
+                                           uint32_t message_id);
+
+/* (room, user) 의 unread 메시지마다, 그 사용자가 읽은 뒤 남을 unread 수 (한 번의 그룹 쿼리).
+ * chat_repo_clear_unread 전에 부른다. 없으면 (NULL, 0).
+ * 삭제와 원자적이지 않아 동시에 읽는 다른 사용자의 행이 포함될 수 있는 근삿값 */
+int chat_repo_get_read_receipts(uint32_t room_id,
+                                uint32_t user_id,
+                                chat_unread_t **out_receipts,
+                                size_t       *out_count);
\ No newline at end of file
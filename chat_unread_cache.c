@@ -0,0 +1,127 @@
+#include "chat_unread_cache.h"
+#include "chat_repository.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define UNREAD_STRIPES    64      /* 잠금 구간 수 */
+#define UNREAD_BUCKETS    1024    /* 구간별 버킷 수 */
+#define UNREAD_RECONCILE  60      /* 기본 reconcile 주기(초) */
+
+typedef struct unread_ent {
+    uint32_t           room_id, user_id;
+    uint32_t           count;
+    time_t             loaded;    /* 마지막으로 DB 값과 맞춘 시각 */
+    struct unread_ent *next;
+} unread_ent_t;
+
+typedef struct {
+    pthread_mutex_t mtx;
+    unread_ent_t   *bk[UNREAD_BUCKETS];
+} unread_stripe_t;
+
+static unread_stripe_t stripes[UNREAD_STRIPES];
+static int reconcile = UNREAD_RECONCILE;
+
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+static void init_stripes(void) {
+    for (int i = 0; i < UNREAD_STRIPES; i++) {
+        pthread_mutex_init(&stripes[i].mtx, NULL);
+    }
+}
+
+void chat_unread_cache_init(int reconcile_sec) {
+    pthread_once(&once, init_stripes);
+    reconcile = reconcile_sec > 0 ? reconcile_sec : UNREAD_RECONCILE;
+}
+
+static uint32_t hash(uint32_t room_id, uint32_t user_id) {
+    uint64_t k = ((uint64_t) room_id << 32) | user_id;
+    k *= 0x9E3779B97F4A7C15ull;
+    return (uint32_t) (k >> 32);
+}
+
+#define STRIPE(h) (&stripes[(h) % UNREAD_STRIPES])
+#define BUCKET(h) (((h) / UNREAD_STRIPES) % UNREAD_BUCKETS)
+
+// 버킷에서 찾기. 지나가면서 오래 안 쓰인 항목(주기의 2배)은 정리
+static unread_ent_t *lookup(unread_ent_t **pp, uint32_t room_id, uint32_t user_id, time_t now) {
+    while (*pp) {
+        unread_ent_t *e = *pp;
+        if (e->room_id == room_id && e->user_id == user_id) return e;
+        if (now - e->loaded > 2 * reconcile) {
+            *pp = e->next;
+            free(e);
+            continue;
+        }
+        pp = &e->next;
+    }
+    return NULL;
+}
+
+int chat_unread_cache_get(uint32_t room_id, uint32_t user_id, uint32_t *out_count) {
+    pthread_once(&once, init_stripes);
+    uint32_t h = hash(room_id, user_id);
+    unread_stripe_t *s = STRIPE(h);
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&s->mtx);
+    unread_ent_t *e = lookup(&s->bk[BUCKET(h)], room_id, user_id, now);
+    if (e && now - e->loaded < reconcile) {
+        *out_count = e->count;
+        pthread_mutex_unlock(&s->mtx);
+        return 0;
+    }
+    pthread_mutex_unlock(&s->mtx);
+
+    // miss 또는 reconcile: 잠금 밖에서 DB 조회
+    uint32_t cnt;
+    int rc = chat_repo_count_unread(room_id, user_id, &cnt);
+    if (rc != 0) return rc;
+
+    pthread_mutex_lock(&s->mtx);
+    unread_ent_t **pp = &s->bk[BUCKET(h)];
+    e = lookup(pp, room_id, user_id, now);
+    if (!e && (e = malloc(sizeof *e))) {
+        e->room_id = room_id;
+        e->user_id = user_id;
+        e->next    = *pp;
+        *pp        = e;
+    }
+    if (e) {
+        e->count  = cnt;
+        e->loaded = now;
+    }
+    pthread_mutex_unlock(&s->mtx);
+
+    *out_count = cnt;
+    return 0;
+}
+
+void chat_unread_cache_add(uint32_t room_id, const uint32_t *user_ids, size_t n) {
+    pthread_once(&once, init_stripes);
+    time_t now = time(NULL);
+
+    for (size_t i = 0; i < n; i++) {
+        uint32_t h = hash(room_id, user_ids[i]);
+        unread_stripe_t *s = STRIPE(h);
+
+        pthread_mutex_lock(&s->mtx);
+        unread_ent_t *e = lookup(&s->bk[BUCKET(h)], room_id, user_ids[i], now);
+        if (e) e->count++;
+        pthread_mutex_unlock(&s->mtx);
+    }
+}
+
+void chat_unread_cache_clear(uint32_t room_id, uint32_t user_id) {
+    pthread_once(&once, init_stripes);
+    uint32_t h = hash(room_id, user_id);
+    unread_stripe_t *s = STRIPE(h);
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&s->mtx);
+    unread_ent_t *e = lookup(&s->bk[BUCKET(h)], room_id, user_id, now);
+    if (e) e->count = 0;
+    pthread_mutex_unlock(&s->mtx);
+}
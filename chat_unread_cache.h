@@ -0,0 +1,20 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------- (room_id, user_id) 별 unread 개수 캐시 (전 스레드 공용) ----------
+ * 처음 조회할 때 DB 에서 읽어 오고, 이후에는 unread 추가/삭제 시점에
+ * chat_repository 가 직접 갱신한다. DB 와 어긋날 수 있는 경합 구간이 있으므로
+ * 항목마다 reconcile 주기가 지나면 다음 조회 때 DB 값으로 다시 맞춘다. */
+
+/* reconcile 주기(초). 0 이하면 기본값 */
+void chat_unread_cache_init(int reconcile_sec);
+
+/* 0 성공. 캐시에 없거나 주기가 지났으면 DB 조회 (DB 스레드에서만 호출) */
+int  chat_unread_cache_get(uint32_t room_id, uint32_t user_id, uint32_t *out_count);
+
+/* 이미 읽어 둔 항목만 +1 (없는 항목은 다음 조회 때 DB 에서 읽힘) */
+void chat_unread_cache_add(uint32_t room_id, const uint32_t *user_ids, size_t n);
+
+/* 읽음 처리: 0 으로 설정 */
+void chat_unread_cache_clear(uint32_t room_id, uint32_t user_id);
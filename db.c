@@ -1,10 +1,120 @@
 #include "db.h"
+#include <mysql/errmsg.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* TLS 커넥션 포인터 */
 static __thread MYSQL *tls_db = NULL;
 
+/* TLS 준비된 문장 (tls_db 에 묶여 있음) */
+static __thread MYSQL_STMT *tls_stmts[DB_STMT_COUNT];
+
+/* db_thread_init 이 끝난 스레드 (끊긴 뒤 get_db 가 다시 접속해도 되는지) */
+static __thread int tls_ready;
+
+/* 트랜잭션 진행 중이면 끊긴 문장을 새 커넥션에서 재시도하지 않음 */
+static __thread int tls_in_txn;
+
+/* @@auto_increment_increment (커넥션마다 한 번 읽음, 0 이면 아직) */
+static __thread unsigned tls_autoinc_step;
+
+/* unread 멀티로우 INSERT 문 (행 수별로 한 번 생성) */
+#define UNREAD_ROWS_HEAD "INSERT IGNORE INTO chat_message_unread(message_id,user_id) VALUES(?,?)"
+static char unread_add_8[sizeof UNREAD_ROWS_HEAD + 7 * 6];
+static char unread_add_64[sizeof UNREAD_ROWS_HEAD + 63 * 6];
+static char unread_add_512[sizeof UNREAD_ROWS_HEAD + 511 * 6];
+
+/* 메시지 멀티로우 INSERT 문 (그룹 커밋용) */
+#define MSG_ROWS_HEAD "INSERT INTO chat_message(room_id,sender_id,content) VALUES(?,?,?)"
+static char msg_save_8[sizeof MSG_ROWS_HEAD + 7 * 8];
+static char msg_save_64[sizeof MSG_ROWS_HEAD + 63 * 8];
+
+static const char *stmt_sql[DB_STMT_COUNT] = {
+    [DB_STMT_SESSION_FIND] =
+        "SELECT userid, UNIX_TIMESTAMP(expires_at) "
+        "FROM sessions WHERE id = ? LIMIT 1",
+    [DB_STMT_USER_NICK] =
+        "SELECT nickname FROM users WHERE id = ? LIMIT 1",
+    [DB_STMT_ROOM_JOIN] =
+        "INSERT IGNORE INTO chat_room_member(room_id,user_id) VALUES(?,?)",
+    [DB_STMT_ROOM_LEAVE] =
+        "DELETE FROM chat_room_member WHERE room_id=? AND user_id=?",
+    [DB_STMT_ROOM_MEMBERS] =
+        "SELECT user_id FROM chat_room_member WHERE room_id = ?",
+    [DB_STMT_MSG_SAVE]    = MSG_ROWS_HEAD,
+    [DB_STMT_MSG_SAVE_8]  = msg_save_8,
+    [DB_STMT_MSG_SAVE_64] = msg_save_64,
+    [DB_STMT_MSG_ROOM] =
+        "SELECT room_id FROM chat_message WHERE id = ?",
+    [DB_STMT_MSG_UNREAD_COUNT] =
+        "SELECT COUNT(*) FROM chat_message_unread WHERE message_id = ?",
+    [DB_STMT_UNREAD_ADD] = UNREAD_ROWS_HEAD,
+    [DB_STMT_UNREAD_ADD_8]   = unread_add_8,
+    [DB_STMT_UNREAD_ADD_64]  = unread_add_64,
+    [DB_STMT_UNREAD_ADD_512] = unread_add_512,
+    [DB_STMT_UNREAD_CLEAR] =
+        "DELETE u FROM chat_message_unread u "
+        "JOIN chat_message m ON m.id=u.message_id "
+        "WHERE m.room_id=? AND u.user_id=?",
+    [DB_STMT_UNREAD_COUNT] =
+        "SELECT COUNT(*) FROM chat_message_unread u "
+        "JOIN chat_message m ON m.id=u.message_id "
+        "WHERE m.room_id=? AND u.user_id=?",
+    [DB_STMT_UNREAD_BY_ROOM] =
+        "SELECT m.id, COUNT(u.user_id) "
+        "FROM chat_message m "
+        "LEFT JOIN chat_message_unread u ON u.message_id=m.id "
+        "WHERE m.room_id=? "
+        "GROUP BY m.id",
+    [DB_STMT_UNREAD_FOR_USER] =
+        "SELECT u.message_id, COUNT(*) AS cnt "
+        "  FROM chat_message_unread AS u "
+        "  JOIN chat_message        AS m "
+        "    ON m.id = u.message_id "
+        " WHERE m.room_id  = ? "
+        "   AND u.user_id  = ? "
+        " GROUP BY u.message_id",
+    [DB_STMT_UNREAD_FOR_MSG] =
+        "SELECT COUNT(*) "
+        "  FROM chat_message_unread AS u "
+        "  JOIN chat_message        AS m "
+        "    ON m.id = u.message_id "
+        " WHERE m.room_id    = ? "
+        "   AND u.message_id = ?",
+    /* 사용자의 unread 행 각각에 대해 같은 메시지의 다른 사용자 행 수 = 읽음 처리 후 남을 수 */
+    [DB_STMT_UNREAD_RECEIPTS] =
+        "SELECT u.message_id, COUNT(o.user_id) "
+        "  FROM chat_message_unread AS u "
+        "  JOIN chat_message        AS m "
+        "    ON m.id = u.message_id "
+        "  LEFT JOIN chat_message_unread AS o "
+        "    ON o.message_id = u.message_id "
+        "   AND o.user_id   <> u.user_id "
+        " WHERE m.room_id = ? "
+        "   AND u.user_id = ? "
+        " GROUP BY u.message_id",
+};
+
+/* head 는 첫 행까지 든 INSERT 문, tuple 은 이어 붙일 ",(?,...)" */
+static void build_rows_sql(char *buf, size_t cap, const char *head, const char *tuple, int rows) {
+    size_t len = (size_t) snprintf(buf, cap, "%s", head);
+    for (int i = 1; i < rows; i++) {
+        len += (size_t) snprintf(buf + len, cap - len, "%s", tuple);
+    }
+}
+
+static pthread_once_t sql_once = PTHREAD_ONCE_INIT;
+
+static void build_sql(void) {
+    build_rows_sql(unread_add_8,   sizeof unread_add_8,   UNREAD_ROWS_HEAD, ",(?,?)", 8);
+    build_rows_sql(unread_add_64,  sizeof unread_add_64,  UNREAD_ROWS_HEAD, ",(?,?)", 64);
+    build_rows_sql(unread_add_512, sizeof unread_add_512, UNREAD_ROWS_HEAD, ",(?,?)", 512);
+    build_rows_sql(msg_save_8,     sizeof msg_save_8,     MSG_ROWS_HEAD, ",(?,?,?)", 8);
+    build_rows_sql(msg_save_64,    sizeof msg_save_64,    MSG_ROWS_HEAD, ",(?,?,?)", 64);
+}
+
 /* 앱 전체 공용 설정 */
 static struct {
     char host[64], user[64], pass[64], schema[64];
@@ -27,13 +137,34 @@ void db_global_end(void) {
     mysql_library_end();
 }
 
-/* ---------- TLS 커넥션 초기화 ---------- */
-int db_thread_init(void) {
-    if (tls_db) return 0; /* 이미 열린 경우 */
+/* ---------- 준비된 문장 ---------- */
+static void close_stmts(void) {
+    for (int i = 0; i < DB_STMT_COUNT; i++) {
+        if (tls_stmts[i]) mysql_stmt_close(tls_stmts[i]);
+        tls_stmts[i] = NULL;
+    }
+}
 
-    /* 스레드 전용 libmysql 초기화 */
-    mysql_thread_init();
+static int prepare_stmts(void) {
+    pthread_once(&sql_once, build_sql);
+    for (int i = 0; i < DB_STMT_COUNT; i++) {
+        MYSQL_STMT *st = mysql_stmt_init(tls_db);
+        if (!st) goto fail;
+        if (mysql_stmt_prepare(st, stmt_sql[i], strlen(stmt_sql[i]))) {
+            fprintf(stderr, "DB prepare error (stmt %d): %s\n", i, mysql_stmt_error(st));
+            mysql_stmt_close(st);
+            goto fail;
+        }
+        tls_stmts[i] = st;
+    }
+    return 0;
+
+fail:
+    close_stmts();
+    return -1;
+}
 
+static int connect_db(void) {
     tls_db = mysql_init(NULL);
     if (!tls_db) return -1;
 
@@ -44,15 +175,44 @@ int db_thread_init(void) {
                 mysql_error(tls_db));
         mysql_close(tls_db);
         tls_db = NULL;
-        mysql_thread_end();
         return -2;
                             }
     /* 필요하면 SET NAMES utf8mb4; 등 실행 */
+    if (prepare_stmts() != 0) {
+        mysql_close(tls_db);
+        tls_db = NULL;
+        return -3;
+    }
     return 0;
 }
 
+/* 연결이 끊겼을 때: 문장과 커넥션을 버리고 새로 접속해 다시 prepare */
+static int reconnect_db(void) {
+    close_stmts();
+    tls_in_txn       = 0;
+    tls_autoinc_step = 0;
+    if (tls_db) mysql_close(tls_db);
+    tls_db = NULL;
+    return connect_db();
+}
+
+/* ---------- TLS 커넥션 초기화 ---------- */
+int db_thread_init(void) {
+    if (tls_db) return 0; /* 이미 열린 경우 */
+
+    /* 스레드 전용 libmysql 초기화 */
+    mysql_thread_init();
+
+    int rc = connect_db();
+    if (rc != 0) mysql_thread_end();
+    else         tls_ready = 1;
+    return rc;
+}
+
 /* ---------- TLS 커넥션 종료 ---------- */
 void db_thread_cleanup(void) {
+    tls_ready = 0;
+    close_stmts();
     if (tls_db) {
         mysql_close(tls_db);
         tls_db = NULL;
@@ -61,4 +221,85 @@ void db_thread_cleanup(void) {
 }
 
 /* ---------- Getter ---------- */
-MYSQL *get_db(void) { return tls_db; }
+/* 이전 재접속이 실패해 커넥션이 없으면 여기서 다시 시도 (일시적인 DB 재시작 후 복구) */
+MYSQL *get_db(void) {
+    if (!tls_db && tls_ready) reconnect_db();
+    return tls_db;
+}
+
+/* ---------- 준비된 문장 실행 ---------- */
+MYSQL_STMT *db_stmt_exec(db_stmt_id id, MYSQL_BIND *params) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        // 이전 재접속이 실패해 문장이 없으면 여기서 다시 시도
+        if (!tls_stmts[id] && reconnect_db() != 0) return NULL;
+
+        MYSQL_STMT *st = tls_stmts[id];
+        if (params && mysql_stmt_bind_param(st, params)) return NULL;
+        if (mysql_stmt_execute(st) == 0) return st;
+
+        unsigned err = mysql_stmt_errno(st);
+        if (err != CR_SERVER_GONE_ERROR && err != CR_SERVER_LOST) {
+            fprintf(stderr, "DB stmt %d error: %s\n", (int) id, mysql_stmt_error(st));
+            return NULL;
+        }
+
+        fprintf(stderr, "DB connection lost (%u), reconnecting\n", err);
+        // 트랜잭션 안이었으면 앞선 문장도 함께 사라졌으니 새 커넥션에서 이어 가지 않음
+        int in_txn = tls_in_txn;
+        if (reconnect_db() != 0) return NULL;
+        // 쿼리 도중 끊긴 경우(CR_SERVER_LOST)는 실행됐을 수도 있으니 재시도하지 않음
+        if (err == CR_SERVER_LOST || in_txn) return NULL;
+    }
+    return NULL;
+}
+
+void db_stmt_done(MYSQL_STMT *st) {
+    if (st) mysql_stmt_free_result(st);
+}
+
+/* ---------- 트랜잭션 ---------- */
+int db_begin(void) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (!tls_stmts[0] && reconnect_db() != 0) return -1;
+        if (mysql_query(tls_db, "START TRANSACTION") == 0) {
+            tls_in_txn = 1;
+            return 0;
+        }
+        unsigned err = mysql_errno(tls_db);
+        fprintf(stderr, "DB begin error: %s\n", mysql_error(tls_db));
+        if (err != CR_SERVER_GONE_ERROR && err != CR_SERVER_LOST) return -1;
+        // 아직 아무것도 실행 안 했으니 재접속 후 한 번 더
+        if (reconnect_db() != 0) return -1;
+    }
+    return -1;
+}
+
+int db_commit(void) {
+    tls_in_txn = 0;
+    if (!tls_db) return -1;
+    if (mysql_commit(tls_db)) {
+        fprintf(stderr, "DB commit error: %s\n", mysql_error(tls_db));
+        return -1;
+    }
+    return 0;
+}
+
+void db_rollback(void) {
+    tls_in_txn = 0;
+    if (tls_db && mysql_rollback(tls_db)) {
+        fprintf(stderr, "DB rollback error: %s\n", mysql_error(tls_db));
+    }
+}
+
+unsigned db_autoinc_step(void) {
+    if (tls_autoinc_step) return tls_autoinc_step;
+    unsigned step = 1;
+    if (tls_db && mysql_query(tls_db, "SELECT @@auto_increment_increment") == 0) {
+        MYSQL_RES *res = mysql_store_result(tls_db);
+        MYSQL_ROW row = res ? mysql_fetch_row(res) : NULL;
+        if (row && row[0] && atoi(row[0]) > 0) step = (unsigned) atoi(row[0]);
+        if (res) mysql_free_result(res);
+    }
+    tls_autoinc_step = step;
+    return step;
+}
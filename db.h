@@ -16,5 +16,50 @@ void db_global_end(void);
 int db_thread_init(void);
 void db_thread_cleanup(void);
 
-/* -------- 현재 스레드용 커넥션 핸들 -------- */
+/* -------- 현재 스레드용 커넥션 핸들 --------
+ * 앞선 재접속이 실패해 커넥션이 없으면 다시 접속을 시도한다. 그래도 없으면 NULL */
 MYSQL *get_db(void);
+
+/* -------- 준비된 문장 레지스트리 --------
+ * 스레드 커넥션마다 접속 직후 모든 문장을 한 번 prepare 해 두고 재사용한다.
+ * 연결이 끊겨 재접속하면 전부 다시 prepare 된다. */
+typedef enum {
+    DB_STMT_SESSION_FIND,         /* sid → userid, expires */
+    DB_STMT_USER_NICK,            /* user → nickname */
+    DB_STMT_ROOM_JOIN,
+    DB_STMT_ROOM_LEAVE,
+    DB_STMT_ROOM_MEMBERS,
+    DB_STMT_MSG_SAVE,
+    DB_STMT_MSG_SAVE_8,           /* 8행 / 64행 멀티로우 (그룹 커밋) */
+    DB_STMT_MSG_SAVE_64,
+    DB_STMT_MSG_ROOM,             /* message → room */
+    DB_STMT_MSG_UNREAD_COUNT,     /* message 의 unread 수 */
+    DB_STMT_UNREAD_ADD,           /* (message, user) 1행 */
+    DB_STMT_UNREAD_ADD_8,         /* 8행 / 64행 / 512행 멀티로우 */
+    DB_STMT_UNREAD_ADD_64,
+    DB_STMT_UNREAD_ADD_512,
+    DB_STMT_UNREAD_CLEAR,
+    DB_STMT_UNREAD_COUNT,         /* (room, user) unread 수 */
+    DB_STMT_UNREAD_BY_ROOM,       /* 방의 메시지별 unread 수 */
+    DB_STMT_UNREAD_FOR_USER,      /* (room, user) 의 unread 메시지 목록 */
+    DB_STMT_UNREAD_FOR_MSG,       /* (room, message) unread 수 */
+    DB_STMT_UNREAD_RECEIPTS,      /* (room, user) 가 읽으면 남을 메시지별 unread 수 */
+    DB_STMT_COUNT
+} db_stmt_id;
+
+/* 파라미터를 바인딩해 실행. 성공 시 문장 핸들, 실패 시 NULL.
+ * 실행 전에 연결이 끊겨 있었으면 재접속 후 한 번 더 시도한다.
+ * 결과를 다 쓴 뒤 db_stmt_done() 으로 반납 */
+MYSQL_STMT *db_stmt_exec(db_stmt_id id, MYSQL_BIND *params);
+void db_stmt_done(MYSQL_STMT *st);
+
+/* -------- 트랜잭션 (현재 스레드 커넥션) --------
+ * db_begin 뒤 db_stmt_exec 가 실패하면 db_rollback.
+ * 트랜잭션 중 연결이 끊기면 재접속만 하고 문장은 재시도하지 않는다.
+ * db_commit 실패는 반영 여부를 알 수 없음 (-1) */
+int  db_begin(void);
+int  db_commit(void);
+void db_rollback(void);
+
+/* 멀티로우 INSERT 의 연속 auto-increment 간격 (@@auto_increment_increment) */
+unsigned db_autoinc_step(void);
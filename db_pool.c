@@ -0,0 +1,103 @@
+#include "db_pool.h"
+#include "db.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static struct {
+    pthread_mutex_t mtx;
+    pthread_cond_t  cv;
+    db_job_t       *head, *tail;
+    size_t          pending;
+    int             stopping;
+    pthread_t      *tids;
+    int             nworkers;
+} pool = {
+    .mtx = PTHREAD_MUTEX_INITIALIZER,
+    .cv  = PTHREAD_COND_INITIALIZER,
+};
+
+static void run_done(void *arg) {
+    db_job_t *job = arg;
+    job->done(job);
+}
+
+static void *worker_main(void *arg) {
+    (void) arg;
+    if (db_thread_init() != 0) {
+        fprintf(stderr, "ERROR: db_thread_init failed (db worker)\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&pool.mtx);
+        while (!pool.head && !pool.stopping) {
+            pthread_cond_wait(&pool.cv, &pool.mtx);
+        }
+        if (!pool.head) {                     // stopping && 큐 비었음
+            pthread_mutex_unlock(&pool.mtx);
+            break;
+        }
+        db_job_t *job = pool.head;
+        pool.head = job->next;
+        if (!pool.head) pool.tail = NULL;
+        pool.pending--;
+        pthread_mutex_unlock(&pool.mtx);
+
+        job->work(job);
+
+        // 결과는 요청한 reactor 스레드에서 이어서 처리.
+        // 통지를 잃으면 연결이 inflight 로 영영 멈추므로 job 에 내장된 노드로 보냄
+        job->task.fn  = run_done;
+        job->task.arg = job;
+        ws_mailbox_post_task(job->reply, &job->task);
+    }
+
+    db_thread_cleanup();
+    return NULL;
+}
+
+int db_pool_start(int nworkers) {
+    pool.tids = calloc((size_t) nworkers, sizeof *pool.tids);
+    if (!pool.tids) return -1;
+    for (int i = 0; i < nworkers; i++) {
+        if (pthread_create(&pool.tids[i], NULL, worker_main, NULL) != 0) {
+            db_pool_stop();
+            return -1;
+        }
+        pool.nworkers++;
+    }
+    return 0;
+}
+
+void db_pool_stop(void) {
+    pthread_mutex_lock(&pool.mtx);
+    pool.stopping = 1;
+    pthread_cond_broadcast(&pool.cv);
+    pthread_mutex_unlock(&pool.mtx);
+
+    for (int i = 0; i < pool.nworkers; i++) {
+        pthread_join(pool.tids[i], NULL);
+    }
+    free(pool.tids);
+    pool.tids     = NULL;
+    pool.nworkers = 0;
+}
+
+void db_pool_submit(db_job_t *job) {
+    job->next = NULL;
+    pthread_mutex_lock(&pool.mtx);
+    if (pool.tail) pool.tail->next = job;
+    else           pool.head = job;
+    pool.tail = job;
+    pool.pending++;
+    pthread_cond_signal(&pool.cv);
+    pthread_mutex_unlock(&pool.mtx);
+}
+
+size_t db_pool_pending(void) {
+    pthread_mutex_lock(&pool.mtx);
+    size_t n = pool.pending;
+    pthread_mutex_unlock(&pool.mtx);
+    return n;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "ws_mailbox.h"
+
+/* -------- DB 작업 풀 --------
+ * worker 스레드마다 db_thread_init() 으로 자기 커넥션을 갖고,
+ * 작업 큐에서 꺼낸 job 의 work() 를 실행한 뒤
+ * done() 을 요청한 reactor 의 mailbox(eventfd) 로 돌려보낸다.
+ * job 은 호출자 구조체에 내장해서 쓴다 (할당/해제는 호출자 몫). */
+
+typedef struct db_job db_job_t;
+typedef void (*db_job_fn)(db_job_t *job);
+
+struct db_job {
+    db_job_fn       work;    /* worker 스레드: MySQL 호출 */
+    db_job_fn       done;    /* reply 소유 스레드: 결과 반영 */
+    ws_mailbox_t   *reply;   /* 완료 통지 대상 */
+    ws_task_t       task;    /* 완료 통지 노드 (할당 없이 보내 잃지 않음) */
+    struct db_job  *next;
+};
+
+/* worker n 개 시작. 0 성공 */
+int  db_pool_start(int nworkers);
+void db_pool_stop(void);
+
+void db_pool_submit(db_job_t *job);
+
+/* 대기 중인 작업 수 (통계) */
+size_t db_pool_pending(void);
@@ -0,0 +1,228 @@
+#include "room_member_cache.h"
+#include "chat_repository.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROOM_STRIPES    16      /* 잠금 구간 수 */
+#define ROOM_BUCKETS    256     /* 구간별 버킷 수 */
+#define ROOM_CACHE_CAP  4096    /* 기본 최대 방 수 */
+#define ROOM_CACHE_TTL  30      /* 기본 유효 시간(초) */
+
+typedef struct room_ent {
+    uint32_t         room_id;
+    time_t           loaded;   /* DB 에서 읽은 시각 */
+    room_members_t  *snap;
+    struct room_ent *next;
+} room_ent_t;
+
+typedef struct {
+    pthread_mutex_t mtx;
+    unsigned long   epoch;     /* 이 구간의 멤버 변경 횟수 (로드 중 변경 감지) */
+    size_t          n;         /* 이 구간의 방 수 */
+    room_ent_t     *bk[ROOM_BUCKETS];
+} room_stripe_t;
+
+static room_stripe_t stripes[ROOM_STRIPES];
+
+static size_t stripe_cap = ROOM_CACHE_CAP / ROOM_STRIPES;   /* 구간별 상한 */
+static int    cache_ttl  = ROOM_CACHE_TTL;
+
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+static void init_stripes(void) {
+    for (int i = 0; i < ROOM_STRIPES; i++) {
+        pthread_mutex_init(&stripes[i].mtx, NULL);
+    }
+}
+
+void room_members_init(long capacity, int ttl_sec) {
+    if (capacity > 0) stripe_cap = ((size_t) capacity + ROOM_STRIPES - 1) / ROOM_STRIPES;
+    if (ttl_sec  > 0) cache_ttl  = ttl_sec;
+}
+
+static uint32_t hash(uint32_t room_id) {
+    return room_id * 0x9E3779B1u;
+}
+
+#define STRIPE(h) (&stripes[(h) % ROOM_STRIPES])
+#define BUCKET(h) (((h) / ROOM_STRIPES) % ROOM_BUCKETS)
+
+static room_members_t *snap_new(uint32_t room_id, size_t n) {
+    room_members_t *m = malloc(sizeof *m + n * sizeof m->ids[0]);
+    if (!m) return NULL;
+    atomic_init(&m->refcnt, 1);
+    m->room_id = room_id;
+    m->n       = n;
+    return m;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}
+
+void room_members_put(const room_members_t *m) {
+    if (!m) return;
+    room_members_t *w = (room_members_t *) m;
+    if (atomic_fetch_sub_explicit(&w->refcnt, 1, memory_order_acq_rel) == 1) free(w);
+}
+
+static const room_members_t *borrow(room_members_t *m) {
+    atomic_fetch_add_explicit(&m->refcnt, 1, memory_order_relaxed);
+    return m;
+}
+
+static room_ent_t **lookup(room_stripe_t *s, uint32_t h, uint32_t room_id) {
+    room_ent_t **pp = &s->bk[BUCKET(h)];
+    while (*pp && (*pp)->room_id != room_id) pp = &(*pp)->next;
+    return pp;
+}
+
+// 잠금 안에서 호출: 구간이 꽉 찼으면 가장 오래 전에 읽은 방을 뺌
+static void evict_oldest(room_stripe_t *s) {
+    room_ent_t **victim = NULL;
+    for (int b = 0; b < ROOM_BUCKETS; b++) {
+        for (room_ent_t **pp = &s->bk[b]; *pp; pp = &(*pp)->next) {
+            if (!victim || (*pp)->loaded < (*victim)->loaded) victim = pp;
+        }
+    }
+    if (!victim) return;
+    room_ent_t *e = *victim;
+    *victim = e->next;
+    s->n--;
+    room_members_put(e->snap);
+    free(e);
+}
+
+// stale: 이 스냅샷(있으면)은 TTL 과 상관없이 낡은 것으로 보고 다시 읽음
+static int get_snapshot(uint32_t room_id, const room_members_t *stale, const room_members_t **out) {
+    pthread_once(&once, init_stripes);
+    uint32_t h = hash(room_id);
+    room_stripe_t *s = STRIPE(h);
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&s->mtx);
+    room_ent_t *e = *lookup(s, h, room_id);
+    if (e && e->snap != stale && now - e->loaded < cache_ttl) {
+        *out = borrow(e->snap);
+        pthread_mutex_unlock(&s->mtx);
+        return 0;
+    }
+    unsigned long epoch = s->epoch;
+    pthread_mutex_unlock(&s->mtx);
+
+    // miss: 잠금 밖에서 DB 조회 후 정렬된 스냅샷으로
+    uint32_t *ids; size_t n;
+    int rc = chat_repo_get_room_members(room_id, &ids, &n);
+    if (rc != 0) return rc;
+    room_members_t *m = snap_new(room_id, n);
+    if (!m) {
+        free(ids);
+        return -1;
+    }
+    memcpy(m->ids, ids, n * sizeof *ids);
+    free(ids);
+    qsort(m->ids, n, sizeof m->ids[0], cmp_u32);
+
+    // 조회하는 동안 이 구간에 멤버 변경이 있었으면 캐시하지 않음 (이번 호출에만 사용)
+    pthread_mutex_lock(&s->mtx);
+    room_ent_t **pp = lookup(s, h, room_id);
+    e = *pp;
+    if (e && e->loaded >= now && e->snap != stale) {
+        // 그 사이 다른 스레드가 더 새로 읽어 둠
+        room_members_put(m);
+        m = (room_members_t *) borrow(e->snap);
+    } else if (s->epoch == epoch) {
+        if (e) {                    // 낡은 스냅샷 교체 (빌려 간 쪽이 다 쓰면 해제)
+            room_members_put(e->snap);
+            e->snap   = m;
+            e->loaded = now;
+            borrow(m);
+        } else if ((e = malloc(sizeof *e))) {
+            if (s->n >= stripe_cap) {
+                evict_oldest(s);
+                pp = lookup(s, h, room_id);
+            }
+            e->room_id = room_id;
+            e->loaded  = now;
+            e->snap    = m;
+            e->next    = NULL;
+            *pp        = e;
+            s->n++;
+            borrow(m);
+        }
+    }
+    pthread_mutex_unlock(&s->mtx);
+
+    *out = m;
+    return 0;
+}
+
+int room_members_get(uint32_t room_id, const room_members_t **out) {
+    return get_snapshot(room_id, NULL, out);
+}
+
+int room_members_get_for(uint32_t room_id, uint32_t user_id, const room_members_t **out) {
+    int rc = get_snapshot(room_id, NULL, out);
+    if (rc != 0 || room_members_has(*out, user_id)) return rc;
+
+    // 다른 프로세스에서 막 추가된 멤버일 수 있음: 이 스냅샷을 낡은 것으로 보고 다시 읽음
+    const room_members_t *stale = *out;
+    rc = get_snapshot(room_id, stale, out);
+    if (rc != 0) *out = stale;
+    else         room_members_put(stale);
+    return 0;
+}
+
+int room_members_has(const room_members_t *m, uint32_t user_id) {
+    return bsearch(&user_id, m->ids, m->n, sizeof m->ids[0], cmp_u32) != NULL;
+}
+
+// 읽어 둔 방이면 uid 를 넣거나 뺀 새 스냅샷으로 교체 (기존 스냅샷은 빌린 쪽이 다 쓰면 해제)
+static void update(uint32_t room_id, uint32_t user_id, int add) {
+    pthread_once(&once, init_stripes);
+    uint32_t h = hash(room_id);
+    room_stripe_t *s = STRIPE(h);
+
+    pthread_mutex_lock(&s->mtx);
+    s->epoch++;
+    room_ent_t **pp = lookup(s, h, room_id);
+    room_ent_t *e = *pp;
+    if (!e) {
+        pthread_mutex_unlock(&s->mtx);
+        return;
+    }
+
+    room_members_t *old = e->snap;
+    int present = room_members_has(old, user_id);
+    if (present == add) {
+        pthread_mutex_unlock(&s->mtx);
+        return;
+    }
+
+    room_members_t *m = snap_new(room_id, add ? old->n + 1 : old->n - 1);
+    if (!m) {   // 메모리 부족: 캐시에서 빼서 다음 조회 때 다시 읽게
+        *pp = e->next;
+        s->n--;
+        free(e);
+        pthread_mutex_unlock(&s->mtx);
+        room_members_put(old);
+        return;
+    }
+    size_t k = 0;
+    for (size_t i = 0; i < old->n; i++) {
+        if (add && k == i && user_id < old->ids[i]) m->ids[k++] = user_id;
+        if (!add && old->ids[i] == user_id) continue;
+        m->ids[k++] = old->ids[i];
+    }
+    if (add && k < m->n) m->ids[k++] = user_id;
+    e->snap = m;
+    pthread_mutex_unlock(&s->mtx);
+
+    room_members_put(old);
+}
+
+void room_members_add(uint32_t room_id, uint32_t user_id)    { update(room_id, user_id, 1); }
+void room_members_remove(uint32_t room_id, uint32_t user_id) { update(room_id, user_id, 0); }
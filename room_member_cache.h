@@ -0,0 +1,36 @@
+#pragma once
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------- 방 멤버 캐시 (전 스레드 공용) ----------
+ * 방마다 정렬된 user_id 배열 스냅샷을 하나 둔다. 처음 접근할 때 DB 에서 읽고,
+ * chat_repo_join_room()/leave_room() 이 성공하면 새 스냅샷으로 교체한다.
+ * 멤버십은 다른 프로세스(HTTP API)에서도 바뀌므로 TTL 이 지난 스냅샷은 다시 읽고,
+ * 방 수 상한을 넘으면 가장 오래 전에 읽은 방부터 버린다.
+ * 조회하는 쪽은 복사본 대신 참조를 빌려 읽고 다 쓰면 돌려준다. */
+
+typedef struct room_members {
+    atomic_int refcnt;
+    uint32_t   room_id;
+    size_t     n;
+    uint32_t   ids[];      /* 오름차순 */
+} room_members_t;
+
+/* capacity: 최대 방 수, ttl_sec: 스냅샷 유효 시간. 0 이하면 기본값 */
+void room_members_init(long capacity, int ttl_sec);
+
+/* 빌린 스냅샷을 *out 에. 0 성공, 음수 DB 오류 (miss 는 DB 스레드에서만) */
+int  room_members_get(uint32_t room_id, const room_members_t **out);
+/* user_id 가 멤버여야 하는 조회 (입장, 발신): 스냅샷에 없으면 TTL 전이라도
+ * 한 번 DB 에서 다시 읽는다. 그래도 없으면 그 스냅샷 그대로 */
+int  room_members_get_for(uint32_t room_id, uint32_t user_id, const room_members_t **out);
+/* 빌린 스냅샷 반납 (어느 스레드에서든) */
+void room_members_put(const room_members_t *m);
+
+/* 1: 멤버 */
+int  room_members_has(const room_members_t *m, uint32_t user_id);
+
+/* DB 변경 후 호출: 읽어 둔 방이면 새 스냅샷으로 교체 */
+void room_members_add(uint32_t room_id, uint32_t user_id);
+void room_members_remove(uint32_t room_id, uint32_t user_id);
@@ -0,0 +1,154 @@
+#include "session_cache.h"
+#include "session_repository.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SESSION_CACHE_CAP  50000   /* 기본 최대 항목 수 */
+#define SESSION_CACHE_TTL  300     /* 만료 없는 세션의 최대 유효 시간(초) */
+#define SESSION_NEG_TTL    30      /* 없는 sid 음성 캐시 시간(초) */
+#define SID_MAX            64
+
+typedef struct sess_ent {
+    char             sid[SID_MAX + 1];
+    uint32_t         user_id;      /* 0 = 음성 항목 */
+    time_t           exp;          /* 세션 만료 (0 = 없음) */
+    time_t           valid_until;  /* 캐시 유효 시각 */
+    struct sess_ent *hnext;
+    struct sess_ent *prev, *next;  /* 삽입 순서: head 가 가장 오래됨 */
+} sess_ent_t;
+
+static struct {
+    pthread_mutex_t mtx;
+    sess_ent_t    **buckets;
+    size_t          nbuckets;
+    sess_ent_t     *head, *tail;
+    size_t          entries, capacity;
+    int             ttl, neg_ttl;
+} sc = {
+    .mtx      = PTHREAD_MUTEX_INITIALIZER,
+    .capacity = SESSION_CACHE_CAP,
+    .ttl      = SESSION_CACHE_TTL,
+    .neg_ttl  = SESSION_NEG_TTL,
+};
+
+void session_cache_init(long capacity, int ttl_sec, int neg_ttl_sec) {
+    pthread_mutex_lock(&sc.mtx);
+    if (capacity    > 0) sc.capacity = (size_t) capacity;
+    if (ttl_sec     > 0) sc.ttl      = ttl_sec;
+    if (neg_ttl_sec > 0) sc.neg_ttl  = neg_ttl_sec;
+    pthread_mutex_unlock(&sc.mtx);
+}
+
+static int ensure_buckets(void) {
+    if (sc.buckets) return 0;
+    size_t n = 64;
+    while (n < sc.capacity) n <<= 1;
+    sc.buckets = calloc(n, sizeof *sc.buckets);
+    if (!sc.buckets) return -1;
+    sc.nbuckets = n;
+    return 0;
+}
+
+/* FNV-1a */
+static size_t slot(const char *sid) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *) sid; *p; p++) {
+        h = (h ^ *p) * 16777619u;
+    }
+    return (size_t) (h & (sc.nbuckets - 1));
+}
+
+static sess_ent_t *find(const char *sid) {
+    for (sess_ent_t *e = sc.buckets[slot(sid)]; e; e = e->hnext) {
+        if (strcmp(e->sid, sid) == 0) return e;
+    }
+    return NULL;
+}
+
+static void drop(sess_ent_t *e) {
+    for (sess_ent_t **pp = &sc.buckets[slot(e->sid)]; *pp; pp = &(*pp)->hnext) {
+        if (*pp == e) {
+            *pp = e->hnext;
+            break;
+        }
+    }
+    if (e->prev) e->prev->next = e->next; else sc.head = e->next;
+    if (e->next) e->next->prev = e->prev; else sc.tail = e->prev;
+    sc.entries--;
+    free(e);
+}
+
+static void insert(const char *sid, uint32_t user_id, time_t exp, time_t valid_until) {
+    if (ensure_buckets() != 0) return;
+    sess_ent_t *e = find(sid);
+    if (e) drop(e);
+    while (sc.entries >= sc.capacity && sc.head) drop(sc.head);   // 가장 오래된 것부터
+
+    if (!(e = malloc(sizeof *e))) return;
+    snprintf(e->sid, sizeof e->sid, "%s", sid);
+    e->user_id     = user_id;
+    e->exp         = exp;
+    e->valid_until = valid_until;
+
+    size_t b = slot(sid);
+    e->hnext = sc.buckets[b];
+    sc.buckets[b] = e;
+    e->next = NULL;
+    e->prev = sc.tail;
+    if (sc.tail) sc.tail->next = e; else sc.head = e;
+    sc.tail = e;
+    sc.entries++;
+}
+
+int session_cache_find(const char *sid, uint32_t *out_user_id, time_t *out_exp) {
+    if (!sid || strnlen(sid, SID_MAX + 1) > SID_MAX) return 1;
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&sc.mtx);
+    if (ensure_buckets() == 0) {
+        sess_ent_t *e = find(sid);
+        if (e && now < e->valid_until) {
+            int rc = e->user_id ? 0 : 1;
+            if (rc == 0) {
+                if (out_user_id) *out_user_id = e->user_id;
+                if (out_exp)     *out_exp     = e->exp;
+            }
+            pthread_mutex_unlock(&sc.mtx);
+            return rc;
+        }
+        if (e) drop(e);
+    }
+    pthread_mutex_unlock(&sc.mtx);
+
+    // miss: 잠금 밖에서 DB 조회
+    uint32_t uid = 0;
+    time_t   exp = 0;
+    int rc = session_repository_find_id(sid, &uid, &exp);
+    if (rc < 0) return rc;
+    if (rc == 0 && exp != 0 && exp <= now) rc = 1;   // 만료된 세션
+
+    pthread_mutex_lock(&sc.mtx);
+    if (rc == 0) {
+        time_t until = now + sc.ttl;
+        if (exp != 0 && exp < until) until = exp;
+        insert(sid, uid, exp, until);
+    } else {
+        insert(sid, 0, 0, now + sc.neg_ttl);
+    }
+    pthread_mutex_unlock(&sc.mtx);
+
+    if (rc == 0) {
+        if (out_user_id) *out_user_id = uid;
+        if (out_exp)     *out_exp     = exp;
+    }
+    return rc;
+}
+
+time_t session_cache_trust_until(time_t exp) {
+    pthread_mutex_lock(&sc.mtx);
+    time_t until = time(NULL) + sc.ttl;
+    pthread_mutex_unlock(&sc.mtx);
+    return exp != 0 && exp < until ? exp : until;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <stdint.h>
+#include <time.h>
+
+/* ---------- sid → (user_id, 만료 시각) 캐시 (전 스레드 공용) ----------
+ * session_repository_find_id() 앞단. 성공한 조회는 세션 만료 시각까지
+ * (만료가 없으면 최대 유효 시간까지) 재사용하고, 없는 sid 는 짧게
+ * 음성 캐시해서 잘못된 클라이언트가 DB 를 두드리지 못하게 한다.
+ *
+ * 로그아웃/세션 삭제는 다른 프로세스(HTTP API)에서 일어나고 여기로 알려 주는
+ * 경로가 없으므로, 폐기된 세션은 최대 유효 시간(WS_SID_TTL)까지 통과할 수 있다.
+ * 반대로 음성 캐시 때문에 막 발급된 sid 가 그 전에 한 번 조회됐다면
+ * 음성 항목 유효 시간(WS_SID_NEG_TTL, 기본 30초) 동안 거절될 수 있다. */
+
+/* capacity: 최대 항목 수, ttl_sec: 양성 항목 최대 유효 시간,
+ * neg_ttl_sec: 음성 항목 유효 시간. 0 이하면 기본값 */
+void session_cache_init(long capacity, int ttl_sec, int neg_ttl_sec);
+
+/* 반환값은 session_repository_find_id() 와 같음:
+ * 0 성공, 1 세션 없음(만료 포함), 음수 DB 오류 (DB 오류는 캐시하지 않음) */
+int  session_cache_find(const char *sid, uint32_t *out_user_id, time_t *out_exp);
+
+/* 지금 검증한 세션(만료 exp, 0 = 없음)을 다시 묻지 않고 믿어도 되는 시각:
+ * min(exp, 지금 + 최대 유효 시간). 연결에 기록해 두고 지나면 session_cache_find 로 재검증 */
+time_t session_cache_trust_until(time_t exp);
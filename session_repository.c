@@ -1,5 +1,6 @@
 #include <mysql.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
@@ -12,34 +13,20 @@ int session_repository_find_id(
     uint32_t *out_user_id,
     time_t *out_exp
 ) {
-    MYSQL *db = get_db();
-    if (!db) return -1;
-
-    MYSQL_STMT *st = mysql_stmt_init(db);
-    const char *sql =
-            "SELECT userid, UNIX_TIMESTAMP(expires_at) "
-            "FROM sessions WHERE id = ? LIMIT 1";
-
-    if (mysql_stmt_prepare(st, sql, strlen(sql))) {
-        mysql_stmt_close(st);
-        return -2;
-    }
-
     /* 파라미터 바인딩 (sid) */
+    unsigned long sid_len = strnlen(sid, 64);
     MYSQL_BIND pb = {0};
     pb.buffer_type = MYSQL_TYPE_STRING;
     pb.buffer = (char *) sid;
-    pb.buffer_length = 64;
-    mysql_stmt_bind_param(st, &pb);
+    pb.buffer_length = sid_len;
+    pb.length = &sid_len;
 
-    if (mysql_stmt_execute(st)) {
-        mysql_stmt_close(st);
-        return -3;
-    }
+    MYSQL_STMT *st = db_stmt_exec(DB_STMT_SESSION_FIND, &pb);
+    if (!st) return -3;
 
     /* 결과 바인딩 */
     uint32_t uid_val = 0;
-    time_t exp_val = 0;
+    long long exp_val = 0;
 
     MYSQL_BIND rb[2] = {0};
     rb[0].buffer_type = MYSQL_TYPE_LONG;
@@ -49,50 +36,33 @@ int session_repository_find_id(
     rb[1].buffer_type = MYSQL_TYPE_LONGLONG;
     rb[1].buffer = &exp_val;
 
-    mysql_stmt_bind_result(st, rb);
+    if (mysql_stmt_bind_result(st, rb)) {
+        db_stmt_done(st);
+        return -2;
+    }
 
     int fs = mysql_stmt_fetch(st);
-    mysql_stmt_close(st);
+    db_stmt_done(st);
 
     if (fs == MYSQL_NO_DATA) return 1; /* 세션 없음 */
     if (fs) return -4; /* fetch 오류 */
 
     if (out_user_id) *out_user_id = uid_val;
-    if (out_exp) *out_exp = exp_val;
+    if (out_exp) *out_exp = (time_t) exp_val;
     return 0; /* 성공 */
 }
 
 char *session_repository_get_nick(uint32_t user_id) {
-    MYSQL *db = get_db();
-    if (!db) return NULL;
-
-    MYSQL_STMT *st = mysql_stmt_init(db);
-    const char *sql = "SELECT nickname FROM users WHERE id = ? LIMIT 1";
-    if (mysql_stmt_prepare(st, sql, strlen(sql)) != 0) {
-        mysql_stmt_close(st);
-        return NULL;
-    }
-
     /* 파라미터 바인딩 */
     MYSQL_BIND pb = {0};
     pb.buffer_type = MYSQL_TYPE_LONG;
     pb.buffer = &user_id;
-    if (mysql_stmt_bind_param(st, &pb) != 0) {
-        mysql_stmt_close(st);
-        return NULL;
-    }
+    pb.is_unsigned = 1;
 
-    if (mysql_stmt_execute(st) != 0) {
-        mysql_stmt_close(st);
-        return NULL;
-    }
+    MYSQL_STMT *st = db_stmt_exec(DB_STMT_USER_NICK, &pb);
+    if (!st) return NULL;
 
-    /* 결과 메타·바인딩 */
-    MYSQL_RES *meta = mysql_stmt_result_metadata(st);
-    if (!meta) {
-        mysql_stmt_close(st);
-        return NULL;
-    }
+    /* 결과 바인딩 */
     MYSQL_BIND rb = {0};
     /* nickname 최대 64자 가정 */
     char nickbuf[64] = {0};
@@ -102,21 +72,22 @@ char *session_repository_get_nick(uint32_t user_id) {
     rb.buffer_length = sizeof(nickbuf) - 1;
     rb.length = &nicklen;
     if (mysql_stmt_bind_result(st, &rb) != 0) {
-        mysql_free_result(meta);
-        mysql_stmt_close(st);
+        db_stmt_done(st);
         return NULL;
     }
 
-    mysql_stmt_store_result(st);
     char *result = NULL;
-    if (mysql_stmt_fetch(st) == 0 && nicklen > 0) {
+    int fs = mysql_stmt_fetch(st);
+    if ((fs == 0 || fs == MYSQL_DATA_TRUNCATED) && nicklen > 0) {
+        if (nicklen > sizeof(nickbuf) - 1) nicklen = sizeof(nickbuf) - 1;
         /* strdup 으로 힙에 복사 */
         result = malloc(nicklen + 1);
-        memcpy(result, nickbuf, nicklen);
-        result[nicklen] = '\0';
+        if (result) {
+            memcpy(result, nickbuf, nicklen);
+            result[nicklen] = '\0';
+        }
     }
 
-    mysql_free_result(meta);
-    mysql_stmt_close(st);
+    db_stmt_done(st);
     return result;
 }
@@ -0,0 +1,154 @@
+#include "user_cache.h"
+#include "session_repository.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define USER_CACHE_CAP  10000    /* 기본 최대 항목 수 */
+#define USER_CACHE_TTL  300      /* 기본 유효 시간(초) */
+
+typedef struct user_ent {
+    uint32_t         user_id;
+    time_t           loaded;
+    struct user_ent *hnext;          /* 해시 체인 */
+    struct user_ent *prev, *next;    /* LRU: head 가 가장 최근 */
+    char             nick[USER_NICK_MAX];
+} user_ent_t;
+
+static struct {
+    pthread_mutex_t mtx;
+    user_ent_t    **buckets;
+    size_t          nbuckets;
+    user_ent_t     *head, *tail;
+    size_t          entries, capacity;
+    int             ttl;
+    unsigned long   hits, misses, evictions;
+} uc = {
+    .mtx      = PTHREAD_MUTEX_INITIALIZER,
+    .capacity = USER_CACHE_CAP,
+    .ttl      = USER_CACHE_TTL,
+};
+
+void user_cache_init(long capacity, int ttl_sec) {
+    pthread_mutex_lock(&uc.mtx);
+    if (capacity > 0) uc.capacity = (size_t) capacity;
+    if (ttl_sec  > 0) uc.ttl      = ttl_sec;
+    pthread_mutex_unlock(&uc.mtx);
+}
+
+// 잠금 안에서 호출. 버킷 수는 용량에 맞춰 처음 한 번 잡는다
+static int ensure_buckets(void) {
+    if (uc.buckets) return 0;
+    size_t n = 64;
+    while (n < uc.capacity) n <<= 1;
+    uc.buckets = calloc(n, sizeof *uc.buckets);
+    if (!uc.buckets) return -1;
+    uc.nbuckets = n;
+    return 0;
+}
+
+static size_t slot(uint32_t user_id) {
+    return (size_t) ((user_id * 0x9E3779B1u) & (uc.nbuckets - 1));
+}
+
+static user_ent_t *find(uint32_t user_id) {
+    for (user_ent_t *e = uc.buckets[slot(user_id)]; e; e = e->hnext) {
+        if (e->user_id == user_id) return e;
+    }
+    return NULL;
+}
+
+static void lru_unlink(user_ent_t *e) {
+    if (e->prev) e->prev->next = e->next; else uc.head = e->next;
+    if (e->next) e->next->prev = e->prev; else uc.tail = e->prev;
+}
+
+static void lru_push(user_ent_t *e) {
+    e->prev = NULL;
+    e->next = uc.head;
+    if (uc.head) uc.head->prev = e; else uc.tail = e;
+    uc.head = e;
+}
+
+static void drop(user_ent_t *e) {
+    for (user_ent_t **pp = &uc.buckets[slot(e->user_id)]; *pp; pp = &(*pp)->hnext) {
+        if (*pp == e) {
+            *pp = e->hnext;
+            break;
+        }
+    }
+    lru_unlink(e);
+    uc.entries--;
+    free(e);
+}
+
+int user_cache_nick(uint32_t user_id, char *out, size_t cap) {
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&uc.mtx);
+    if (ensure_buckets() == 0) {
+        user_ent_t *e = find(user_id);
+        if (e && now - e->loaded < uc.ttl) {
+            lru_unlink(e);
+            lru_push(e);
+            uc.hits++;
+            snprintf(out, cap, "%s", e->nick);
+            pthread_mutex_unlock(&uc.mtx);
+            return 0;
+        }
+    }
+    uc.misses++;
+    pthread_mutex_unlock(&uc.mtx);
+
+    // miss 또는 만료: 잠금 밖에서 DB 조회
+    char *nick = session_repository_get_nick(user_id);
+    if (!nick) return -1;
+
+    pthread_mutex_lock(&uc.mtx);
+    if (uc.buckets) {
+        user_ent_t *e = find(user_id);
+        if (e) {
+            lru_unlink(e);
+        } else if ((e = malloc(sizeof *e))) {
+            e->user_id = user_id;
+            e->hnext   = uc.buckets[slot(user_id)];
+            uc.buckets[slot(user_id)] = e;
+            uc.entries++;
+        }
+        if (e) {
+            snprintf(e->nick, sizeof e->nick, "%s", nick);
+            e->loaded = now;
+            lru_push(e);
+        }
+        while (uc.entries > uc.capacity && uc.tail) {
+            drop(uc.tail);
+            uc.evictions++;
+        }
+    }
+    pthread_mutex_unlock(&uc.mtx);
+
+    snprintf(out, cap, "%s", nick);
+    free(nick);
+    return 0;
+}
+
+void user_cache_invalidate(uint32_t user_id) {
+    pthread_mutex_lock(&uc.mtx);
+    if (uc.buckets) {
+        user_ent_t *e = find(user_id);
+        if (e) drop(e);
+    }
+    pthread_mutex_unlock(&uc.mtx);
+}
+
+void user_cache_stats(user_cache_stats_t *out) {
+    pthread_mutex_lock(&uc.mtx);
+    out->hits      = uc.hits;
+    out->misses    = uc.misses;
+    out->evictions = uc.evictions;
+    out->entries   = uc.entries;
+    out->bytes     = uc.entries * sizeof(user_ent_t) + uc.nbuckets * sizeof(user_ent_t *);
+    pthread_mutex_unlock(&uc.mtx);
+}
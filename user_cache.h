@@ -0,0 +1,27 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------- 사용자 프로필(닉네임) 캐시 (전 스레드 공용) ----------
+ * session_repository_get_nick() 앞단의 LRU + TTL 캐시.
+ * 항목 수 상한을 넘으면 가장 오래 안 쓴 항목부터 버리고,
+ * TTL 이 지난 항목은 다음 조회 때 DB 에서 다시 읽는다. */
+
+#define USER_NICK_MAX 64   /* 닉네임 최대 길이 (NUL 포함) */
+
+typedef struct {
+    unsigned long hits, misses, evictions;
+    size_t        entries;
+    size_t        bytes;     /* 항목 + 해시 버킷 메모리 */
+} user_cache_stats_t;
+
+/* capacity: 최대 항목 수, ttl_sec: 유효 시간. 0 이하면 기본값 */
+void user_cache_init(long capacity, int ttl_sec);
+
+/* 닉네임을 out 에 복사. 0 성공, -1 없음/DB 오류 (miss 는 DB 스레드에서만) */
+int  user_cache_nick(uint32_t user_id, char *out, size_t cap);
+
+/* 닉네임 변경 등으로 무효화 */
+void user_cache_invalidate(uint32_t user_id);
+
+void user_cache_stats(user_cache_stats_t *out);
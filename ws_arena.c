@@ -0,0 +1,18 @@
+#include "ws_arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+int ws_arena_init(ws_arena_t *a, size_t cap) {
+    memset(a, 0, sizeof *a);
+    if (posix_memalign((void **) &a->base, WS_ARENA_ALIGN, cap ? cap : WS_ARENA_ALIGN) != 0) {
+        a->base = NULL;
+        return -1;
+    }
+    a->cap = cap;
+    return 0;
+}
+
+void ws_arena_destroy(ws_arena_t *a) {
+    free(a->base);
+    memset(a, 0, sizeof *a);
+}
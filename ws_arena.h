@@ -0,0 +1,36 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------- bump arena (스레드 하나 전용) ----------
+ * 한 요청 안에서 잡고 버리는 작은 할당들을 연속 블록에서 앞으로만 잘라 주고,
+ * 요청이 끝나면 used 를 0 으로 돌려 한 번에 비운다 (O(1)).
+ * 개별 해제는 없음. 남은 자리가 모자라면 NULL 이므로 호출자가 힙으로 넘긴다. */
+
+#define WS_ARENA_ALIGN 16
+
+typedef struct {
+    uint8_t *base;
+    size_t   cap;
+    size_t   used;
+    size_t   peak;      /* used 최댓값 */
+} ws_arena_t;
+
+int  ws_arena_init(ws_arena_t *a, size_t cap);     /* 0 성공, -1 메모리 부족 */
+void ws_arena_destroy(ws_arena_t *a);
+
+static inline void *ws_arena_alloc(ws_arena_t *a, size_t n) {
+    size_t at = (a->used + WS_ARENA_ALIGN - 1) & ~(size_t) (WS_ARENA_ALIGN - 1);
+    if (at > a->cap || n > a->cap - at) return NULL;
+    a->used = at + n;
+    if (a->used > a->peak) a->peak = a->used;
+    return a->base + at;
+}
+
+static inline int ws_arena_owns(const ws_arena_t *a, const void *p) {
+    return a->base && (const uint8_t *) p >= a->base && (const uint8_t *) p < a->base + a->cap;
+}
+
+static inline void ws_arena_reset(ws_arena_t *a) {
+    a->used = 0;
+}
@@ -0,0 +1,82 @@
+#include "ws_bufpool.h"
+#include <stdlib.h>
+
+#define KEEP_BYTES (256 * 1024)   /* 클래스당 보관 상한 */
+#define KEEP_MIN   4
+
+typedef struct buf_node {
+    struct buf_node *next;
+} buf_node_t;
+
+typedef struct {
+    buf_node_t *free[WS_BUF_CLASSES];
+    size_t      nfree[WS_BUF_CLASSES];
+    ws_bufpool_stats_t st;
+} pool_t;
+
+static __thread pool_t pool;
+
+// n 을 담는 가장 작은 클래스, 범위 밖이면 -1
+static int class_of(size_t n) {
+    if (n > ((size_t) 1 << WS_BUF_MAX_SHIFT)) return -1;
+    int c = 0;
+    while (((size_t) 1 << (WS_BUF_MIN_SHIFT + c)) < n) c++;
+    return c;
+}
+
+static size_t keep_limit(int c) {
+    size_t n = KEEP_BYTES >> (WS_BUF_MIN_SHIFT + c);
+    return n < KEEP_MIN ? KEEP_MIN : n;
+}
+
+static void note_out(size_t cap) {
+    pool.st.in_use += cap;
+    if (pool.st.in_use > pool.st.peak) pool.st.peak = pool.st.in_use;
+}
+
+void *ws_buf_get(size_t n, size_t *cap) {
+    int c = class_of(n ? n : 1);
+    if (c < 0) {
+        void *p = malloc(n);
+        if (!p) return NULL;
+        pool.st.misses++;
+        *cap = n;
+        note_out(n);
+        return p;
+    }
+    size_t size = (size_t) 1 << (WS_BUF_MIN_SHIFT + c);
+    buf_node_t *b = pool.free[c];
+    if (b) {
+        pool.free[c] = b->next;
+        pool.nfree[c]--;
+        pool.st.cached -= size;
+        pool.st.hits++;
+    } else {
+        if (!(b = malloc(size))) return NULL;
+        pool.st.misses++;
+    }
+    *cap = size;
+    note_out(size);
+    return b;
+}
+
+void ws_buf_put(void *p, size_t cap) {
+    if (!p) return;
+    pool.st.in_use = pool.st.in_use > cap ? pool.st.in_use - cap : 0;
+
+    int c = class_of(cap);
+    // 클래스 크기와 정확히 같은 것만 보관 (64KiB 초과 직접 할당분은 해제)
+    if (c < 0 || ((size_t) 1 << (WS_BUF_MIN_SHIFT + c)) != cap || pool.nfree[c] >= keep_limit(c)) {
+        free(p);
+        return;
+    }
+    buf_node_t *b = p;
+    b->next = pool.free[c];
+    pool.free[c] = b;
+    pool.nfree[c]++;
+    pool.st.cached += cap;
+}
+
+void ws_bufpool_stats(ws_bufpool_stats_t *out) {
+    *out = pool.st;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <stddef.h>
+
+/* ---------- 크기별 버퍼 풀 (스레드별, 잠금 없음) ----------
+ * 256B ~ 64KiB 2의 거듭제곱 크기 버퍼를 스레드마다 free list 로 재사용한다.
+ * reactor 스레드의 수신 경로(입력 버퍼, 조립 중인 메시지, 잘려 온 제어 프레임)가 쓴다.
+ * 반환은 받은 스레드에서 하는 것이 원칙이고, 다른 스레드에서 돌려주면 그 스레드 풀로 간다.
+ * 크기 클래스마다 보관 개수에 상한이 있어 유휴 메모리는 클래스당 약 256KiB 이하. */
+
+#define WS_BUF_MIN_SHIFT 8      /* 256B */
+#define WS_BUF_MAX_SHIFT 16     /* 64KiB, 이보다 크면 malloc/free 로 직접 */
+#define WS_BUF_CLASSES   (WS_BUF_MAX_SHIFT - WS_BUF_MIN_SHIFT + 1)
+
+/* n 바이트 이상 버퍼. *cap 에 실제 크기 (ws_buf_put 에 그대로 넘김). 실패하면 NULL */
+void *ws_buf_get(size_t n, size_t *cap);
+void  ws_buf_put(void *p, size_t cap);
+
+typedef struct {
+    unsigned long hits;       /* 풀에서 바로 내준 횟수 */
+    unsigned long misses;     /* 새로 할당한 횟수 (빈 클래스 또는 64KiB 초과) */
+    size_t        in_use;     /* 지금 나가 있는 버퍼 바이트 */
+    size_t        peak;       /* in_use 최댓값 (high-water mark) */
+    size_t        cached;     /* 풀에 보관 중인 바이트 */
+} ws_bufpool_stats_t;
+
+/* 호출한 스레드의 풀 통계 */
+void ws_bufpool_stats(ws_bufpool_stats_t *out);
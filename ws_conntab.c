@@ -0,0 +1,61 @@
+#include "ws_conntab.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INIT_SLOTS 1024
+#define INIT_HOT   256
+
+int ws_conntab_add(ws_conntab_t *t, int fd, void *obj, uint64_t *key) {
+    if (fd < 0) return -1;
+
+    // fd 는 작은 정수부터 재사용되므로 최대 fd 까지 두 배씩 늘림
+    if ((size_t) fd >= t->nslots) {
+        size_t n = t->nslots ? t->nslots : INIT_SLOTS;
+        while (n <= (size_t) fd) n *= 2;
+        ws_conn_slot_t *s = realloc(t->slots, n * sizeof *s);
+        if (!s) return -1;
+        memset(s + t->nslots, 0, (n - t->nslots) * sizeof *s);
+        t->slots  = s;
+        t->nslots = n;
+    }
+    ws_conn_slot_t *slot = &t->slots[fd];
+    if (slot->pos) return -1;
+
+    if (t->n == t->cap) {
+        size_t cap = t->cap ? t->cap * 2 : INIT_HOT;
+        ws_conn_hot_t *h = realloc(t->hot, cap * sizeof *h);
+        if (!h) return -1;
+        t->hot = h;
+        t->cap = cap;
+    }
+    slot->gen++;
+    slot->pos = (uint32_t) ++t->n;
+    t->hot[t->n - 1] = (ws_conn_hot_t) {
+        .fd  = fd,
+        .gen = slot->gen,
+        .obj = obj,
+    };
+    *key = ws_conn_key(fd, slot->gen);
+    return 0;
+}
+
+void ws_conntab_del(ws_conntab_t *t, int fd) {
+    if (fd < 0 || (size_t) fd >= t->nslots || !t->slots[fd].pos) return;
+    ws_conn_slot_t *slot = &t->slots[fd];
+    size_t i    = slot->pos - 1;
+    size_t last = t->n - 1;
+
+    // 마지막 원소를 빈자리로 옮겨 빈틈 없이 유지
+    if (i != last) {
+        t->hot[i] = t->hot[last];
+        t->slots[t->hot[i].fd].pos = (uint32_t) i + 1;
+    }
+    t->n--;
+    slot->pos = 0;
+}
+
+void ws_conntab_free(ws_conntab_t *t) {
+    free(t->slots);
+    free(t->hot);
+    memset(t, 0, sizeof *t);
+}
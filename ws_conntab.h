@@ -0,0 +1,60 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------- fd 로 찾는 연결 표 (reactor 전용, 잠금 없음) ----------
+ * slots[fd] 가 연결의 세대와 hot[] 위치를 가리키고, hot[] 은 살아 있는 연결의
+ * 자주 보는 필드를 빈틈 없이 모아 둔 배열이라 전체 순회가 연속 메모리를 훑는다.
+ * 추가/조회/삭제 O(1) (삭제는 마지막 원소를 빈자리로 옮김).
+ *
+ * epoll 에는 (세대 << 32 | fd) 키를 등록한다. 연결이 닫히면 fd 슬롯의 세대가 올라가므로
+ * 같은 fd 가 재사용된 뒤에 도착한 이전 연결의 이벤트는 조회에서 걸러진다. */
+
+#define WS_CONN_READY 0x1   /* 핸드셰이크 완료, 닫는 중 아님 (브로드캐스트 대상) */
+
+typedef struct {
+    int       fd;
+    uint32_t  gen;
+    uint32_t  state;    /* WS_CONN_* */
+    int       room_id;  /* 소속 방 (0 = 없음) */
+    void     *obj;      /* 연결 구조체 */
+} ws_conn_hot_t;
+
+typedef struct {
+    uint32_t gen;       /* 이 fd 에 연결이 들어올 때마다 증가 */
+    uint32_t pos;       /* hot[] 위치 + 1, 0 이면 비어 있음 */
+} ws_conn_slot_t;
+
+typedef struct {
+    ws_conn_slot_t *slots;      /* fd 로 인덱스 */
+    size_t          nslots;
+    ws_conn_hot_t  *hot;
+    size_t          n;          /* 살아 있는 연결 수 */
+    size_t          cap;
+} ws_conntab_t;
+
+static inline uint64_t ws_conn_key(int fd, uint32_t gen) {
+    return (uint64_t) gen << 32 | (uint32_t) fd;
+}
+
+/* 0 성공 (*key 에 epoll 등록용 키), -1 메모리 부족 또는 이미 있는 fd */
+int ws_conntab_add(ws_conntab_t *t, int fd, void *obj, uint64_t *key);
+
+/* epoll 키로 조회: 세대가 다르거나 비어 있으면 NULL */
+static inline ws_conn_hot_t *ws_conntab_lookup(const ws_conntab_t *t, uint64_t key) {
+    uint32_t fd = (uint32_t) key;
+    if (fd >= t->nslots) return NULL;
+    const ws_conn_slot_t *s = &t->slots[fd];
+    if (!s->pos || s->gen != (uint32_t) (key >> 32)) return NULL;
+    return &t->hot[s->pos - 1];
+}
+
+/* fd 로 조회 (세대 무시): 없으면 NULL */
+static inline ws_conn_hot_t *ws_conntab_get(const ws_conntab_t *t, int fd) {
+    if (fd < 0 || (size_t) fd >= t->nslots || !t->slots[fd].pos) return NULL;
+    return &t->hot[t->slots[fd].pos - 1];
+}
+
+void ws_conntab_del(ws_conntab_t *t, int fd);
+
+void ws_conntab_free(ws_conntab_t *t);
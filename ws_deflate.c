@@ -0,0 +1,146 @@
+#include "ws_deflate.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+static int deflate_min   = WS_DEFLATE_MIN;
+static int deflate_level = WS_DEFLATE_LEVEL;
+
+static atomic_ulong st_frames, st_in, st_out;
+
+/* 스레드별 스트림 (no_context_takeover 라 메시지마다 reset 해서 재사용) */
+static __thread z_stream zd, zi;
+static __thread int      zd_ready, zi_ready;
+
+static const uint8_t TAIL[4] = { 0x00, 0x00, 0xFF, 0xFF };
+
+void ws_deflate_config(int min_size, int level) {
+    if (min_size > 0)              deflate_min   = min_size;
+    if (level > 0 && level <= 9)   deflate_level = level;
+}
+
+// payload 압축본 프레임. 이득이 없거나 실패하면 NULL
+static ws_msg_t *compress_msg(ws_msg_t *m) {
+    if (!zd_ready) {
+        if (deflateInit2(&zd, deflate_level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return NULL;
+        }
+        zd_ready = 1;
+    } else {
+        deflateReset(&zd);
+    }
+
+    size_t    plen = ws_msg_payload_len(m);
+    ws_msg_t *z    = ws_msg_new(deflateBound(&zd, plen) + 8);
+    if (!z) return NULL;
+
+    zd.next_in   = ws_msg_payload(m);
+    zd.avail_in  = (uInt) plen;
+    zd.next_out  = ws_msg_payload(z);
+    zd.avail_out = (uInt) z->cap;
+    int rc = deflate(&zd, Z_SYNC_FLUSH);
+    size_t zlen = z->cap - zd.avail_out;
+    if (rc != Z_OK || zd.avail_in != 0 || zlen < 4) {
+        ws_msg_unref(z);
+        return NULL;
+    }
+
+    // sync flush 가 붙인 00 00 FF FF 는 보내지 않음 (RFC 7692 7.2.1)
+    if (memcmp(ws_msg_payload(z) + zlen - 4, TAIL, 4) == 0) zlen -= 4;
+    if (zlen >= plen) {
+        ws_msg_unref(z);
+        return NULL;
+    }
+
+    ws_msg_seal(z, (uint8_t) m->opcode, zlen);
+    z->frame[0] |= WS_RSV1;
+    atomic_store_explicit(&z->zmsg, z, memory_order_relaxed);   // 다시 압축하지 않음
+
+    atomic_fetch_add_explicit(&st_frames, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&st_in, plen, memory_order_relaxed);
+    atomic_fetch_add_explicit(&st_out, zlen, memory_order_relaxed);
+    return z;
+}
+
+ws_msg_t *ws_msg_deflated(ws_msg_t *m) {
+    if (m->opcode != WS_OP_TEXT && m->opcode != WS_OP_BINARY) return m;
+    if (ws_msg_payload_len(m) < (size_t) deflate_min) return m;
+
+    ws_msg_t *z = atomic_load_explicit(&m->zmsg, memory_order_acquire);
+    if (z) return z;
+
+    // 여러 reactor 가 동시에 만들 수 있음: 먼저 넣은 쪽을 쓰고 나머지는 버림
+    z = compress_msg(m);
+    if (!z) z = m;
+    ws_msg_t *expect = NULL;
+    if (!atomic_compare_exchange_strong_explicit(&m->zmsg, &expect, z,
+                                                 memory_order_acq_rel, memory_order_acquire)) {
+        if (z != m) ws_msg_unref(z);
+        z = expect;
+    }
+    return z;
+}
+
+int ws_inflate(const uint8_t *in, size_t len, size_t max, uint8_t **out, size_t *out_len) {
+    if (!zi_ready) {
+        if (inflateInit2(&zi, -MAX_WBITS) != Z_OK) return -1;
+        zi_ready = 1;
+    } else {
+        inflateReset(&zi);
+    }
+
+    size_t cap = len * 4 + 64;
+    if (cap > max + 1) cap = max + 1;
+    uint8_t *buf = malloc(cap);
+    if (!buf) return -1;
+
+    size_t n = 0;
+    // 본문 다음에 떼어 낸 00 00 FF FF 를 이어서 넣음
+    const uint8_t *parts[2] = { in, TAIL };
+    size_t         plens[2] = { len, sizeof TAIL };
+    for (int p = 0; p < 2; p++) {
+        zi.next_in  = (Bytef *) parts[p];
+        zi.avail_in = (uInt) plens[p];
+        // 입력을 다 넣었고 출력 공간이 남았으면(= 더 나올 것 없음) 다음 조각으로
+        for (;;) {
+            if (n == cap) {
+                if (cap > max) {
+                    free(buf);
+                    return -2;
+                }
+                size_t ncap = cap * 2 > max + 1 ? max + 1 : cap * 2;
+                uint8_t *nb = realloc(buf, ncap);
+                if (!nb) {
+                    free(buf);
+                    return -1;
+                }
+                buf = nb;
+                cap = ncap;
+            }
+            zi.next_out  = buf + n;
+            zi.avail_out = (uInt) (cap - n);
+            int rc = inflate(&zi, Z_SYNC_FLUSH);
+            n = cap - zi.avail_out;
+            if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR) {
+                free(buf);
+                return -1;
+            }
+            if (rc == Z_STREAM_END) break;
+            if (zi.avail_in == 0 && zi.avail_out > 0) break;
+        }
+    }
+    if (n > max) {
+        free(buf);
+        return -2;
+    }
+    *out     = buf;
+    *out_len = n;
+    return 0;
+}
+
+void ws_deflate_stats(ws_deflate_stats_t *out) {
+    out->frames    = atomic_load_explicit(&st_frames, memory_order_relaxed);
+    out->in_bytes  = atomic_load_explicit(&st_in, memory_order_relaxed);
+    out->out_bytes = atomic_load_explicit(&st_out, memory_order_relaxed);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "ws_frame.h"
+
+/* ---------- permessage-deflate (RFC 7692) ----------
+ * 협상은 항상 server_no_context_takeover + client_no_context_takeover 로 한다.
+ * 그러면 메시지마다 압축 상태가 독립이라
+ *   - 송신: 같은 프레임의 압축본을 한 번 만들어 모든 수신자가 공유하고
+ *   - 수신: 연결별 inflate 상태 없이 스레드별 스트림 하나를 재사용한다. */
+
+#define WS_DEFLATE_MIN    256          /* 이보다 작은 payload 는 압축하지 않음 */
+#define WS_DEFLATE_LEVEL  6
+
+/* min_size / level 이 0 이하면 기본값 */
+void ws_deflate_config(int min_size, int level);
+
+/* 보낼 프레임: 압축할 가치가 있으면 공유 압축본(RSV1), 아니면 m 그대로.
+ * 반환값은 m 이 참조를 잡고 있으므로 m 이 살아 있는 동안 유효 */
+ws_msg_t *ws_msg_deflated(ws_msg_t *m);
+
+/* 받은 압축 payload 해제. 0 성공 (*out 은 호출자가 free), -1 형식 오류, -2 크기 초과 */
+int ws_inflate(const uint8_t *in, size_t len, size_t max, uint8_t **out, size_t *out_len);
+
+typedef struct {
+    unsigned long frames;     /* 압축본을 만든 프레임 수 */
+    unsigned long in_bytes;   /* 압축 전 payload 합 */
+    unsigned long out_bytes;  /* 압축 후 payload 합 */
+} ws_deflate_stats_t;
+
+void ws_deflate_stats(ws_deflate_stats_t *out);
@@ -0,0 +1,107 @@
+#include "ws_event.h"
+#include "ws_json.h"
+#include <string.h>
+
+// 필드 없이 type 만 있는 이벤트
+static ws_msg_t *type_only(const char *type) {
+    ws_jw_t w;
+    ws_jw_begin(&w, 32);
+    ws_jw_object_begin(&w);
+    ws_jw_str(&w, "type", type, strlen(type));
+    ws_jw_object_end(&w);
+    return ws_jw_finish(&w);
+}
+
+ws_msg_t *ws_ev_auth_ok(void) {
+    return type_only("auth_ok");
+}
+
+ws_msg_t *ws_ev_ping(void) {
+    return type_only("ping");
+}
+
+ws_msg_t *ws_ev_updated_chat_room(void) {
+    return type_only("updated-chat-room");
+}
+
+ws_msg_t *ws_ev_unread(uint32_t room, uint32_t count) {
+    ws_jw_t w;
+    ws_jw_begin(&w, 64);
+    ws_jw_object_begin(&w);
+    ws_jw_str(&w, "type", "unread", 6);
+    ws_jw_int(&w, "room",  room);
+    ws_jw_int(&w, "count", count);
+    ws_jw_object_end(&w);
+    return ws_jw_finish(&w);
+}
+
+ws_msg_t *ws_ev_joined(uint32_t room, const uint32_t *users, size_t n) {
+    ws_jw_t w;
+    ws_jw_begin(&w, 48 + n * 11);   // 원소당 최대 10자리 + ','
+    ws_jw_object_begin(&w);
+    ws_jw_str(&w, "type", "joined", 6);
+    ws_jw_int(&w, "room", room);
+    ws_jw_array_begin(&w, "users");
+    for (size_t i = 0; i < n; i++) ws_jw_elem_int(&w, users[i]);
+    ws_jw_array_end(&w);
+    ws_jw_object_end(&w);
+    return ws_jw_finish(&w);
+}
+
+ws_msg_t *ws_ev_left(uint32_t room, uint32_t user) {
+    ws_jw_t w;
+    ws_jw_begin(&w, 64);
+    ws_jw_object_begin(&w);
+    ws_jw_str(&w, "type", "left", 4);
+    ws_jw_int(&w, "room", room);
+    ws_jw_int(&w, "user", user);
+    ws_jw_object_end(&w);
+    return ws_jw_finish(&w);
+}
+
+ws_msg_t *ws_ev_updated_message(uint32_t id, uint32_t unread_cnt) {
+    ws_jw_t w;
+    ws_jw_begin(&w, 80);
+    ws_jw_object_begin(&w);
+    ws_jw_str(&w, "type",       "updated-message", 15);
+    ws_jw_int(&w, "id",         id);
+    ws_jw_int(&w, "unread_cnt", unread_cnt);
+    ws_jw_object_end(&w);
+    return ws_jw_finish(&w);
+}
+
+ws_msg_t *ws_ev_updated_messages(const chat_unread_t *rows, size_t n) {
+    ws_jw_t w;
+    ws_jw_begin(&w, 64 + n * 40);   // 원소당 {"id":,"unread_cnt":} + 숫자 두 개
+    ws_jw_object_begin(&w);
+    ws_jw_str(&w, "type", "updated-messages", 16);
+    ws_jw_array_begin(&w, "messages");
+    for (size_t i = 0; i < n; i++) {
+        ws_jw_object_begin(&w);
+        ws_jw_int(&w, "id",         rows[i].message_id);
+        ws_jw_int(&w, "unread_cnt", rows[i].count);
+        ws_jw_object_end(&w);
+    }
+    ws_jw_array_end(&w);
+    ws_jw_object_end(&w);
+    return ws_jw_finish(&w);
+}
+
+ws_msg_t *ws_ev_message(uint32_t room, uint32_t id, uint32_t sender, const char *nick,
+                        const char *content, size_t content_len, time_t ts, uint32_t unread_cnt) {
+    size_t nick_len = strlen(nick);
+    ws_jw_t w;
+    // 고정 부분 + 숫자 최대 길이 + 문자열 (이스케이프가 드물어 원래 길이로 충분, 모자라면 자람)
+    ws_jw_begin(&w, 160 + nick_len + content_len);
+    ws_jw_object_begin(&w);
+    ws_jw_str(&w, "type",       "message", 7);
+    ws_jw_int(&w, "room",       room);
+    ws_jw_int(&w, "id",         id);
+    ws_jw_int(&w, "sender",     sender);
+    ws_jw_str(&w, "nick",       nick, nick_len);
+    ws_jw_str(&w, "content",    content, content_len);
+    ws_jw_int(&w, "ts",         (int64_t) ts);
+    ws_jw_int(&w, "unread_cnt", unread_cnt);
+    ws_jw_object_end(&w);
+    return ws_jw_finish(&w);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "ws_frame.h"
+#include "chat_repository.h"
+
+/* ---------- 송신 이벤트 ----------
+ * 이벤트 종류별로 JSON 을 공유 프레임에 바로 써서 봉인된 ws_msg_t 로 돌려준다 (refcnt = 1).
+ * 할당 실패는 NULL. 필드 순서/이름은 클라이언트가 보는 형식 그대로 */
+
+ws_msg_t *ws_ev_auth_ok(void);
+ws_msg_t *ws_ev_ping(void);                                         /* JSON heartbeat 호환 모드 */
+ws_msg_t *ws_ev_unread(uint32_t room, uint32_t count);
+ws_msg_t *ws_ev_joined(uint32_t room, const uint32_t *users, size_t n);
+ws_msg_t *ws_ev_left(uint32_t room, uint32_t user);
+ws_msg_t *ws_ev_updated_message(uint32_t id, uint32_t unread_cnt);
+/* 여러 메시지의 새 unread 수를 한 이벤트로: {"type":"updated-messages","messages":[{"id","unread_cnt"},...]} */
+ws_msg_t *ws_ev_updated_messages(const chat_unread_t *rows, size_t n);
+ws_msg_t *ws_ev_updated_chat_room(void);
+ws_msg_t *ws_ev_message(uint32_t room, uint32_t id, uint32_t sender, const char *nick,
+                        const char *content, size_t content_len, time_t ts, uint32_t unread_cnt);
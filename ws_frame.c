@@ -1,44 +1,262 @@
 #include "ws_frame.h"
 #include "ws_util.h"
+#include "ws_mask.h"
+#include "ws_bufpool.h"
 #include <arpa/inet.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <endian.h>
+#include <pthread.h>
 
 /* ---------- 수신 ---------- */
-int ws_recv(int fd, ws_frame_t *o) {
-    uint8_t hdr[2];
-    if (readn(fd, hdr, 2) != 2) return -1;
-
-    o->fin = hdr[0] & 0x80;
-    o->opcode = hdr[0] & 0x0F;
-    int mask = hdr[1] & 0x80;
-    uint64_t len = hdr[1] & 0x7F;
-
-    if (len == 126) {
-        uint16_t l16;
-        readn(fd, &l16, 2);
-        len = ntohs(l16);
-    } else if (len == 127) {
-        uint64_t l64;
-        readn(fd, &l64, 8);
-        len = be64toh(l64);
+static size_t max_message = WS_MESSAGE_MAX;
+static __thread unsigned long inplace_frames;
+
+void ws_reader_config(size_t max) {
+    if (max > 0) max_message = max;
+}
+
+size_t ws_reader_max_message(void) {
+    return max_message;
+}
+
+unsigned long ws_reader_inplace_frames(void) {
+    return inplace_frames;
+}
+
+void ws_frame_free(ws_frame_t *f) {
+    if (f->owner == WS_PAYLOAD_POOLED)    ws_buf_put(f->payload, f->cap);
+    else if (f->owner == WS_PAYLOAD_HEAP) free(f->payload);
+    f->payload = NULL;
+    f->owner   = WS_PAYLOAD_HEAP;
+}
+
+static void reader_reset(ws_reader_t *r) {
+    r->state  = WS_RD_HEADER;
+    r->need   = 2;
+    r->have   = 0;
+    r->masked = 0;
+    r->got    = 0;
+    memset(r->mkey, 0, sizeof r->mkey);
+    memset(&r->cur, 0, sizeof r->cur);
+}
+
+// 입력 버퍼 (연결마다 WS_RBUF_SIZE, 풀에서)
+static int reader_alloc(ws_reader_t *r) {
+    size_t cap;
+    r->buf = ws_buf_get(WS_RBUF_SIZE, &cap);
+    if (!r->buf) return -1;
+    reader_reset(r);
+    return 0;
+}
+
+ssize_t ws_reader_fill(ws_reader_t *r, int fd) {
+    if (!r->buf && reader_alloc(r) < 0) return -1;
+    // 모두 소비된 버퍼는 처음부터 다시 사용
+    if (r->pos == r->len) r->pos = r->len = 0;
+    if (r->len == WS_RBUF_SIZE) return 0;
+
+    for (;;) {
+        ssize_t n = read(fd, r->buf + r->len, WS_RBUF_SIZE - r->len);
+        if (n > 0) { r->len += n; return n; }
+        if (n == 0) return -1;                       // peer 종료
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+        return -1;
+    }
+}
+
+int ws_reader_feed(ws_reader_t *r, const void *data, size_t len) {
+    if (!r->buf && reader_alloc(r) < 0) return -1;
+    if (r->pos == r->len) r->pos = r->len = 0;
+    if (len > WS_RBUF_SIZE - r->len) return -1;
+    memcpy(r->buf + r->len, data, len);
+    r->len += len;
+    return 0;
+}
+
+static int fail(ws_reader_t *r, uint16_t code) {
+    r->err = code;
+    return -1;
+}
+
+/* 헤더 + 길이까지 받은 프레임 검사 (payload 메모리를 잡기 전): 0 통과, -1 거절 */
+static int check_frame(ws_reader_t *r) {
+    const ws_frame_t *f = &r->cur;
+    if (!r->masked) return fail(r, WS_CLOSE_PROTOCOL);             // 클라이언트 프레임은 반드시 마스킹
+
+    if (WS_OP_IS_CONTROL(f->opcode)) {
+        if (f->opcode != WS_OP_CLOSE && f->opcode != WS_OP_PING && f->opcode != WS_OP_PONG)
+            return fail(r, WS_CLOSE_PROTOCOL);
+        if (!f->fin || f->rsv1 || f->len > WS_CONTROL_MAX) return fail(r, WS_CLOSE_PROTOCOL);
+        return 0;
     }
-    uint8_t mkey[4];
-    if (mask) readn(fd, mkey, 4);
 
-    o->payload = malloc(len);
-    if (!o->payload) return -1;
-    if (readn(fd, o->payload, len) != (ssize_t) len) return -1;
+    if (f->opcode == WS_OP_CONT) {
+        if (!r->msg_op || f->rsv1) return fail(r, WS_CLOSE_PROTOCOL);   // RSV1 은 첫 프레임에만
+    } else if (f->opcode == WS_OP_TEXT || f->opcode == WS_OP_BINARY) {
+        if (r->msg_op) return fail(r, WS_CLOSE_PROTOCOL);            // 이전 메시지가 안 끝남
+    } else {
+        return fail(r, WS_CLOSE_PROTOCOL);
+    }
+    if (f->len > max_message - r->msg_len) return fail(r, WS_CLOSE_TOO_BIG);
+    return 0;
+}
 
-    if (mask)
-        for (uint64_t i = 0; i < len; ++i)
-            o->payload[i] ^= mkey[i & 3];
-    o->len = len;
+/* 메시지 버퍼를 need 바이트 이상으로. 단일 프레임 메시지는 정확히 한 번,
+ * 조각 메시지는 두 배씩 늘려 재할당 횟수를 로그 수준으로 유지 */
+static int reserve_msg(ws_reader_t *r, size_t need) {
+    if (need <= r->msg_cap && r->msg) return 0;
+    size_t want = need;
+    if (r->msg_cap && r->msg_cap * 2 > want) want = r->msg_cap * 2;
+    if (want > max_message) want = max_message;   // need <= max_message 는 check_frame 이 보장
+    size_t cap;
+    uint8_t *p = ws_buf_get(want, &cap);
+    if (!p) return -1;
+    if (r->msg_len) memcpy(p, r->msg, r->msg_len);
+    ws_buf_put(r->msg, r->msg_cap);
+    r->msg     = p;
+    r->msg_cap = cap;
     return 0;
 }
 
+/* 프레임 payload 가 다 찼을 때: 1 꺼낼 것 있음, 0 계속 (조각 중) */
+static int end_frame(ws_reader_t *r, ws_frame_t *out) {
+    if (WS_OP_IS_CONTROL(r->cur.opcode)) {
+        *out = r->cur;
+        reader_reset(r);
+        return 1;
+    }
+    if (!r->msg_op) {
+        r->msg_op   = r->cur.opcode;
+        r->msg_rsv1 = r->cur.rsv1;
+    }
+    r->msg_len += (size_t) r->cur.len;
+    int fin = r->cur.fin;
+    reader_reset(r);
+    if (!fin) return 0;
+
+    out->fin     = 1;
+    out->rsv1    = r->msg_rsv1;
+    out->opcode  = r->msg_op;
+    out->owner   = WS_PAYLOAD_POOLED;
+    out->len     = r->msg_len;
+    out->payload = r->msg;
+    out->cap     = r->msg_cap;
+    r->msg      = NULL;
+    r->msg_len  = r->msg_cap = 0;
+    r->msg_op   = r->msg_rsv1 = 0;
+    return 1;
+}
+
+/* 마스크 키까지 받은 뒤 payload 단계 진입: 1 꺼낼 것 있음, 0 계속, -1 오류 */
+static int begin_payload(ws_reader_t *r, ws_frame_t *out) {
+    int control = WS_OP_IS_CONTROL(r->cur.opcode);
+
+    // 그 자체로 완결된 프레임이 입력 버퍼에 다 들어와 있으면 제자리에서 풀어 빌려줌
+    if ((control || (r->cur.fin && !r->msg_op)) && r->cur.len <= r->len - r->pos) {
+        uint8_t *p = r->buf + r->pos;
+        ws_mask_copy(p, p, (size_t) r->cur.len, r->mkey, 0);
+        r->pos += (size_t) r->cur.len;
+        *out = r->cur;
+        out->payload = p;
+        out->owner   = WS_PAYLOAD_BORROWED;
+        reader_reset(r);
+        inplace_frames++;
+        return 1;
+    }
+
+    if (control) {
+        r->cur.payload = ws_buf_get(r->cur.len, &r->cur.cap);
+        if (!r->cur.payload) return fail(r, WS_CLOSE_INTERNAL);
+        r->cur.owner = WS_PAYLOAD_POOLED;
+    } else if (reserve_msg(r, r->msg_len + (size_t) r->cur.len) < 0) {
+        return fail(r, WS_CLOSE_INTERNAL);
+    }
+    if (r->cur.len == 0) return end_frame(r, out);
+    r->state = WS_RD_PAYLOAD;
+    return 0;
+}
+
+int ws_reader_next(ws_reader_t *r, ws_frame_t *out) {
+    if (!r->buf) return 0;
+
+    while (r->pos < r->len) {
+        size_t avail = r->len - r->pos;
+
+        // payload : 받은 만큼 언마스킹하며 제어 프레임 버퍼 / 메시지 버퍼로 복사
+        if (r->state == WS_RD_PAYLOAD) {
+            uint64_t left = r->cur.len - r->got;
+            size_t   take = left < avail ? (size_t) left : avail;
+            uint8_t *dst  = WS_OP_IS_CONTROL(r->cur.opcode) ? r->cur.payload
+                                                             : r->msg + r->msg_len;
+            ws_mask_copy(dst + r->got, r->buf + r->pos, take, r->mkey, (size_t) r->got);
+            r->got += take;
+            r->pos += take;
+            if (r->got < r->cur.len) return 0;
+            int rc = end_frame(r, out);
+            if (rc) return rc;
+            continue;
+        }
+
+        // 헤더/확장 길이/마스크 : need 바이트를 tmp 에 모음
+        size_t take = r->need - r->have;
+        if (take > avail) take = avail;
+        memcpy(r->tmp + r->have, r->buf + r->pos, take);
+        r->have += take;
+        r->pos  += take;
+        if (r->have < r->need) return 0;
+        r->have = 0;
+
+        if (r->state == WS_RD_HEADER) {
+            if (r->tmp[0] & WS_RSV23) return fail(r, WS_CLOSE_PROTOCOL);
+            r->cur.fin    = r->tmp[0] & 0x80;
+            r->cur.rsv1   = r->tmp[0] & WS_RSV1;
+            r->cur.opcode = r->tmp[0] & 0x0F;
+            r->masked     = r->tmp[1] & 0x80;
+            uint8_t len7  = r->tmp[1] & 0x7F;
+            if (len7 >= 126) {
+                // 제어 프레임은 확장 길이를 쓸 수 없음: 더 받기 전에 거절
+                if (WS_OP_IS_CONTROL(r->cur.opcode)) return fail(r, WS_CLOSE_PROTOCOL);
+                r->state = WS_RD_EXTLEN;
+                r->need  = len7 == 126 ? 2 : 8;
+                continue;
+            }
+            r->cur.len = len7;
+        } else if (r->state == WS_RD_EXTLEN) {
+            if (r->need == 2) {
+                uint16_t l16;
+                memcpy(&l16, r->tmp, 2);
+                r->cur.len = ntohs(l16);
+            } else {
+                uint64_t l64;
+                memcpy(&l64, r->tmp, 8);
+                r->cur.len = be64toh(l64);
+                if (r->cur.len >> 63) return fail(r, WS_CLOSE_PROTOCOL);   // 최상위 비트는 0 이어야 함
+            }
+        } else { /* WS_RD_MASK */
+            memcpy(r->mkey, r->tmp, 4);
+            int rc = begin_payload(r, out);
+            if (rc) return rc;
+            continue;
+        }
+
+        // 길이 확정: 검사 후 마스크 키로
+        if (check_frame(r) < 0) return -1;
+        r->state = WS_RD_MASK;
+        r->need  = 4;
+    }
+    return 0;
+}
+
+void ws_reader_free(ws_reader_t *r) {
+    ws_frame_free(&r->cur);   // 제어 프레임 수신 중일 때만 payload 가 있음
+    ws_buf_put(r->msg, r->msg_cap);
+    ws_buf_put(r->buf, WS_RBUF_SIZE);
+    memset(r, 0, sizeof *r);
+}
+
 /* ---------- 송신: Text Frame (len 무관) ---------- */
 size_t ws_build_text_frame(const uint8_t *msg, size_t len, uint8_t *buf) {
     size_t pos = 0;
@@ -71,3 +289,134 @@ size_t ws_build_text_frame(const uint8_t *msg, size_t len, uint8_t *buf) {
 
     return pos;
 }
+
+/* ---------- 송신: 공유 프레임 ---------- */
+/* ---------- 송신: 제어 프레임 ---------- */
+size_t ws_build_control_frame(uint8_t opcode, const void *payload, size_t len, uint8_t *out) {
+    if (len > WS_CONTROL_MAX) return 0;
+    out[0] = 0x80 | (opcode & 0x0F);   // 제어 프레임은 조각낼 수 없음: FIN=1
+    out[1] = (uint8_t) len;
+    if (len) memcpy(out + 2, payload, len);
+    return 2 + len;
+}
+
+// close payload = 2바이트 상태 코드(network order) + UTF-8 이유
+static size_t close_payload(uint16_t code, const char *reason, uint8_t *out) {
+    if (!code) return 0;
+    out[0] = (uint8_t) (code >> 8);
+    out[1] = (uint8_t) code;
+    size_t rl = reason ? strnlen(reason, WS_CONTROL_MAX - 2) : 0;
+    if (rl) memcpy(out + 2, reason, rl);
+    return 2 + rl;
+}
+
+int ws_close_code_valid(uint16_t code) {
+    if (code >= 1000 && code <= 1003) return 1;
+    if (code >= 1007 && code <= 1014) return 1;   // 1012-1014 는 IANA 등록 코드
+    return code >= 3000 && code <= 4999;          // 라이브러리/애플리케이션용
+}
+
+size_t ws_build_close_frame(uint16_t code, const char *reason, uint8_t *out) {
+    uint8_t p[WS_CONTROL_MAX];
+    size_t  pl = close_payload(code, reason, p);
+    return ws_build_control_frame(WS_OP_CLOSE, p, pl, out);
+}
+
+ws_msg_t *ws_msg_new(size_t payload_cap) {
+    ws_msg_t *m = malloc(sizeof *m + WS_MSG_HEADROOM + payload_cap);
+    if (!m) return NULL;
+    atomic_init(&m->refcnt, 1);
+    m->cap    = payload_cap;
+    m->frame  = m->data + WS_MSG_HEADROOM;
+    m->len    = 0;
+    m->opcode = -1;
+    atomic_init(&m->zmsg, NULL);
+    return m;
+}
+
+ws_msg_t *ws_msg_grow(ws_msg_t *m, size_t payload_cap) {
+    if (payload_cap <= m->cap) return m;
+    ws_msg_t *n = realloc(m, sizeof *m + WS_MSG_HEADROOM + payload_cap);
+    if (!n) return NULL;
+    n->cap   = payload_cap;
+    n->frame = n->data + WS_MSG_HEADROOM;
+    return n;
+}
+
+void ws_msg_seal(ws_msg_t *m, uint8_t opcode, size_t len) {
+    uint8_t hdr[WS_MSG_HEADROOM];
+    size_t  hl = 0;
+
+    hdr[hl++] = 0x80 | (opcode & 0x0F);
+    if (len < 126) {
+        hdr[hl++] = (uint8_t)len;
+    } else if (len <= 0xFFFF) {
+        hdr[hl++] = 126;
+        hdr[hl++] = (len >> 8) & 0xFF;
+        hdr[hl++] = len & 0xFF;
+    } else {
+        hdr[hl++] = 127;
+        for (int i = 7; i >= 0; --i) {
+            hdr[hl++] = (len >> (8 * i)) & 0xFF;
+        }
+    }
+
+    // payload 바로 앞에 헤더를 붙임 (payload 는 움직이지 않음)
+    m->frame = ws_msg_payload(m) - hl;
+    memcpy(m->frame, hdr, hl);
+    m->len = hl + len;
+    m->opcode = opcode & 0x0F;
+}
+
+ws_msg_t *ws_msg_text(const void *payload, size_t len) {
+    ws_msg_t *m = ws_msg_new(len);
+    if (!m) return NULL;
+    if (len) memcpy(ws_msg_payload(m), payload, len);
+    ws_msg_seal(m, 0x1, len);
+    return m;
+}
+
+ws_msg_t *ws_msg_raw(const void *bytes, size_t len) {
+    ws_msg_t *m = ws_msg_new(len);
+    if (!m) return NULL;
+    memcpy(ws_msg_payload(m), bytes, len);
+    m->len = len;
+    return m;
+}
+
+ws_msg_t *ws_msg_control(uint8_t opcode, const void *payload, size_t len) {
+    if (len > WS_CONTROL_MAX) return NULL;
+    ws_msg_t *m = ws_msg_new(len);
+    if (!m) return NULL;
+    if (len) memcpy(ws_msg_payload(m), payload, len);
+    ws_msg_seal(m, opcode, len);
+    return m;
+}
+
+ws_msg_t *ws_msg_close(uint16_t code, const char *reason) {
+    ws_msg_t *m = ws_msg_new(WS_CONTROL_MAX);
+    if (!m) return NULL;
+    ws_msg_seal(m, WS_OP_CLOSE, close_payload(code, reason, ws_msg_payload(m)));
+    return m;
+}
+
+// 빈 ping 은 내용이 항상 같으므로 한 번만 만들고, 참조 하나를 영구히 잡아 둠
+static ws_msg_t      *ping_msg;
+static pthread_once_t ping_once = PTHREAD_ONCE_INIT;
+
+static void build_ping(void) {
+    ping_msg = ws_msg_control(WS_OP_PING, NULL, 0);
+}
+
+ws_msg_t *ws_msg_ping(void) {
+    pthread_once(&ping_once, build_ping);
+    return ping_msg;
+}
+
+void ws_msg_unref(ws_msg_t *m) {
+    if (m && atomic_fetch_sub_explicit(&m->refcnt, 1, memory_order_acq_rel) == 1) {
+        ws_msg_t *z = atomic_load_explicit(&m->zmsg, memory_order_acquire);
+        if (z && z != m) ws_msg_unref(z);
+        free(m);
+    }
+}
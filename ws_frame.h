@@ -1,14 +1,164 @@
 #pragma once
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/types.h>
+
+/* opcode (RFC 6455 5.2) */
+#define WS_OP_CONT   0x0
+#define WS_OP_TEXT   0x1
+#define WS_OP_BINARY 0x2
+#define WS_OP_CLOSE  0x8
+#define WS_OP_PING   0x9
+#define WS_OP_PONG   0xA
+#define WS_OP_IS_CONTROL(op) ((op) & 0x8)
+
+#define WS_CONTROL_MAX 125   /* 제어 프레임 payload 최대 길이 */
+
+/* close 상태 코드 (RFC 6455 7.4.1) */
+#define WS_CLOSE_NORMAL     1000
+#define WS_CLOSE_GOING_AWAY 1001
+#define WS_CLOSE_PROTOCOL   1002
+#define WS_CLOSE_POLICY     1008
+#define WS_CLOSE_TOO_BIG    1009
+#define WS_CLOSE_INTERNAL   1011
+
+#define WS_RSV1      0x40    /* permessage-deflate: 압축된 메시지 */
+#define WS_RSV23     0x30    /* 확장이 정의하지 않은 예약 비트 */
+
+/* payload 가 어디서 왔는지 (ws_frame_free 가 맞게 돌려줌) */
+#define WS_PAYLOAD_HEAP     0   /* malloc (NULL 가능) */
+#define WS_PAYLOAD_BORROWED 1   /* 연결의 입력 버퍼 안: 다음 fill/feed 전까지만 유효 */
+#define WS_PAYLOAD_POOLED   2   /* 스레드 버퍼 풀 (cap 크기) */
 
 typedef struct {
     uint8_t fin;
+    uint8_t rsv1;       /* 압축 비트 (협상된 연결에서만 허용) */
     uint8_t opcode;
+    uint8_t owner;      /* WS_PAYLOAD_* */
     uint64_t len;
     uint8_t *payload;
+    size_t   cap;       /* POOLED 일 때 버퍼 크기 */
 } ws_frame_t;
 
-int ws_recv(int fd, ws_frame_t *out);
+/* payload 반납 (빌린 것이면 아무것도 안 함) */
+void ws_frame_free(ws_frame_t *f);
+
+/* ---------- 수신: 증분 프레임 파서 ----------
+ * 조각난 데이터 메시지(FIN=0 + continuation)는 연결별 버퍼에 이어 붙여
+ * 완성된 메시지 하나로 돌려준다. 사이에 끼어 온 제어 프레임은 조립을 멈추지 않고
+ * 그때그때 따로 돌려준다. 길이/opcode/예약 비트/마스크는 헤더 단계에서 검사해
+ * payload 메모리를 잡기 전에 거절한다.
+ * 한 번에 다 들어온 단일 프레임은 입력 버퍼 안에서 제자리 언마스킹해 빌려주고(할당 없음),
+ * 나머지 버퍼는 스레드별 버퍼 풀(ws_bufpool)에서 가져온다. */
+#define WS_RBUF_SIZE    4096        /* 커넥션별 read() 입력 버퍼 크기 */
+#define WS_MESSAGE_MAX  (1 << 20)   /* 조립된(압축 해제 후 포함) 메시지 최대 크기 기본값 */
+
+typedef enum {
+    WS_RD_HEADER,   /* FIN/opcode + MASK/len7 (2바이트) */
+    WS_RD_EXTLEN,   /* 16/64비트 확장 길이 */
+    WS_RD_MASK,     /* 마스킹 키 (4바이트) */
+    WS_RD_PAYLOAD   /* payload 본문 */
+} ws_rd_state_t;
+
+typedef struct {
+    uint8_t      *buf;      /* read() 로 채우는 입력 버퍼 (지연 할당) */
+    size_t        len;      /* 버퍼에 쌓인 바이트 수 */
+    size_t        pos;      /* 파서가 소비한 위치 */
+
+    ws_rd_state_t state;
+    uint8_t       tmp[8];   /* 헤더/확장 길이/마스크 조립용 */
+    size_t        need;     /* 현재 상태에서 모아야 할 바이트 */
+    size_t        have;     /* 지금까지 모은 바이트 */
+    int           masked;
+    uint8_t       mkey[4];
+    ws_frame_t    cur;      /* 조립 중인 프레임 (데이터 프레임은 payload 없이 헤더만) */
+    uint64_t      got;      /* 채워진 payload 바이트 */
+
+    uint8_t      *msg;      /* 조립 중인 데이터 메시지 */
+    size_t        msg_len;
+    size_t        msg_cap;
+    uint8_t       msg_op;   /* 첫 프레임 opcode, 0 이면 조립 중 아님 */
+    uint8_t       msg_rsv1;
+
+    uint16_t      err;      /* ws_reader_next 가 -1 일 때 보낼 close 코드 */
+} ws_reader_t;
+
+/* 메시지 최대 크기 (0 이면 기본값 유지). 시작 시 한 번 */
+void   ws_reader_config(size_t max_message);
+size_t ws_reader_max_message(void);
+
+/* 소켓에서 읽을 수 있는 만큼 읽음: >0 읽은 바이트, 0 EAGAIN, -1 EOF/오류 */
+ssize_t ws_reader_fill(ws_reader_t *r, int fd);
+
+/* 소켓 외 경로로 받은 바이트를 입력 버퍼에 추가 (핸드셰이크 뒤 잔여 데이터 등) */
+int ws_reader_feed(ws_reader_t *r, const void *data, size_t len);
+
+/* 완성된 메시지 또는 제어 프레임 하나를 꺼냄: 1 있음, 0 데이터 부족,
+ * -1 규격 위반/크기 초과 (r->err 에 close 코드).
+ * 데이터 메시지는 opcode 가 첫 프레임 것(TEXT/BINARY), fin = 1.
+ * 반환된 out 은 호출자가 ws_frame_free(). 빌린 payload 는 수정해도 되지만
+ * 다음 ws_reader_fill/feed 전에 다 써야 한다 */
+int ws_reader_next(ws_reader_t *r, ws_frame_t *out);
+
+void ws_reader_free(ws_reader_t *r);
+
+/* 이 스레드에서 입력 버퍼 안에서 바로 내준(할당 없는) 프레임 수 */
+unsigned long ws_reader_inplace_frames(void);
 
 size_t ws_build_text_frame(const uint8_t *msg, size_t len, uint8_t *out);
+
+/* 제어 프레임 (ping/pong/close): out 은 2 + WS_CONTROL_MAX 바이트 이상.
+ * 작성한 바이트 수, payload 가 너무 길면 0 */
+size_t ws_build_control_frame(uint8_t opcode, const void *payload, size_t len, uint8_t *out);
+
+/* close 프레임: 상태 코드 + 이유(잘려서 들어감). code 가 0 이면 payload 없음 */
+size_t ws_build_close_frame(uint16_t code, const char *reason, uint8_t *out);
+
+/* 상대가 보낸 close 상태 코드가 유효한지 (RFC 6455 7.4.1/7.4.2).
+ * 1005/1006/1015 처럼 전송 금지인 값, 1000 미만, 미지정 구간은 0 */
+int ws_close_code_valid(uint16_t code);
+
+/* ---------- 송신: 공유 프레임 ----------
+ * payload 를 한 번만 직렬화하고 여러 연결의 송신 큐가 참조로 공유한다.
+ * data 앞쪽 WS_MSG_HEADROOM 바이트를 비워두고, 길이가 확정되면
+ * 헤더를 payload 바로 앞에 써서 복사 없이 프레임을 완성한다.
+ * 봉인(seal) 이후에는 읽기 전용이라 reactor 간에 그대로 넘겨도 된다. */
+#define WS_MSG_HEADROOM 10   /* 최대 서버 프레임 헤더 (2 + 8) */
+
+typedef struct ws_msg {
+    atomic_int refcnt;
+    size_t     cap;     /* payload 용량 */
+    uint8_t   *frame;   /* 전송 시작 위치 (seal 이후 유효) */
+    size_t     len;     /* 전송할 전체 길이 */
+    int        opcode;  /* seal 한 opcode, 원시 바이트는 -1 */
+    _Atomic(struct ws_msg *) zmsg;  /* 압축본 (처음 필요할 때 한 번 만듦, 자신 = 압축 안 함) */
+    uint8_t    data[];  /* [headroom][payload] */
+} ws_msg_t;
+
+ws_msg_t *ws_msg_new(size_t payload_cap);                  /* refcnt = 1 */
+static inline uint8_t *ws_msg_payload(ws_msg_t *m) { return m->data + WS_MSG_HEADROOM; }
+/* seal 이후 payload 길이 */
+static inline size_t ws_msg_payload_len(ws_msg_t *m) { return (size_t) (m->frame + m->len - ws_msg_payload(m)); }
+
+/* seal 전, 아직 공유하지 않은 메시지의 payload 용량을 늘림 (내용 유지).
+ * 실패하면 NULL 이고 m 은 그대로 유효 */
+ws_msg_t *ws_msg_grow(ws_msg_t *m, size_t payload_cap);
+
+/* payload_len 바이트가 채워진 payload 앞에 헤더 작성 (FIN=1) */
+void ws_msg_seal(ws_msg_t *m, uint8_t opcode, size_t payload_len);
+
+ws_msg_t *ws_msg_text(const void *payload, size_t len);   /* 복사 + seal(text) */
+ws_msg_t *ws_msg_raw(const void *bytes, size_t len);      /* 헤더 없는 원시 바이트 (HTTP 응답 등) */
+ws_msg_t *ws_msg_control(uint8_t opcode, const void *payload, size_t len);  /* len > 125 면 NULL */
+ws_msg_t *ws_msg_close(uint16_t code, const char *reason);
+
+/* 미리 만들어 둔 빈 ping 프레임 (프로세스 공용, 해제되지 않음).
+ * 다른 메시지처럼 송신 큐에 넣고 ref/unref 해도 된다 */
+ws_msg_t *ws_msg_ping(void);
+
+static inline ws_msg_t *ws_msg_ref(ws_msg_t *m) {
+    atomic_fetch_add_explicit(&m->refcnt, 1, memory_order_relaxed);
+    return m;
+}
+void ws_msg_unref(ws_msg_t *m);
@@ -0,0 +1,100 @@
+#include "ws_group.h"
+#include <stdlib.h>
+
+#define GROUP_INIT_BUCKETS 64
+
+static size_t slot(const ws_group_map_t *m, uint32_t id) {
+    // Fibonacci hashing: 연속된 id 도 고르게 분산
+    return (size_t) ((id * 2654435769u) >> 7) & (m->nbuckets - 1);
+}
+
+static int grow(ws_group_map_t *m) {
+    size_t nb = m->nbuckets ? m->nbuckets * 2 : GROUP_INIT_BUCKETS;
+    ws_group_t **nbk = calloc(nb, sizeof *nbk);
+    if (!nbk) return -1;
+
+    ws_group_map_t tmp = { .buckets = nbk, .nbuckets = nb };
+    for (size_t i = 0; i < m->nbuckets; i++) {
+        ws_group_t *g = m->buckets[i];
+        while (g) {
+            ws_group_t *n = g->hnext;
+            size_t s  = slot(&tmp, g->id);
+            g->hnext  = nbk[s];
+            nbk[s]    = g;
+            g = n;
+        }
+    }
+    free(m->buckets);
+    m->buckets  = nbk;
+    m->nbuckets = nb;
+    return 0;
+}
+
+ws_group_t *ws_group_find(const ws_group_map_t *m, uint32_t id) {
+    if (!m->nbuckets) return NULL;
+    for (ws_group_t *g = m->buckets[slot(m, id)]; g; g = g->hnext) {
+        if (g->id == id) return g;
+    }
+    return NULL;
+}
+
+int ws_group_add(ws_group_map_t *m, uint32_t id, ws_group_link_t *l) {
+    if (l->group) {
+        if (l->group->id == id) return 0;
+        ws_group_remove(m, l);
+    }
+
+    ws_group_t *g = ws_group_find(m, id);
+    if (!g) {
+        if (m->ngroups >= m->nbuckets && grow(m) < 0) return -1;
+        g = calloc(1, sizeof *g);
+        if (!g) return -1;
+        g->id = id;
+        size_t s = slot(m, id);
+        g->hnext = m->buckets[s];
+        m->buckets[s] = g;
+        m->ngroups++;
+    }
+
+    l->prev  = NULL;
+    l->next  = g->head;
+    if (g->head) g->head->prev = l;
+    g->head  = l;
+    l->group = g;
+    g->count++;
+    return 0;
+}
+
+void ws_group_remove(ws_group_map_t *m, ws_group_link_t *l) {
+    ws_group_t *g = l->group;
+    if (!g) return;
+
+    if (l->prev) l->prev->next = l->next;
+    else         g->head       = l->next;
+    if (l->next) l->next->prev = l->prev;
+    l->prev = l->next = NULL;
+    l->group = NULL;
+
+    if (--g->count) return;
+
+    // 빈 그룹은 해시에서 떼어내 해제
+    ws_group_t **pp = &m->buckets[slot(m, g->id)];
+    while (*pp != g) pp = &(*pp)->hnext;
+    *pp = g->hnext;
+    m->ngroups--;
+    free(g);
+}
+
+void ws_group_map_free(ws_group_map_t *m) {
+    for (size_t i = 0; i < m->nbuckets; i++) {
+        ws_group_t *g = m->buckets[i];
+        while (g) {
+            ws_group_t *n = g->hnext;
+            free(g);
+            g = n;
+        }
+    }
+    free(m->buckets);
+    m->buckets  = NULL;
+    m->nbuckets = m->ngroups = 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------- id → 연결 목록 (방/사용자 인덱스) ----------
+ * 연결 구조체에 ws_group_link_t 를 내장(intrusive)하고,
+ * 그룹 해시맵이 id 별로 링크를 이중 연결 리스트로 묶는다. */
+
+struct ws_group;
+
+typedef struct ws_group_link {
+    struct ws_group_link *prev, *next;
+    struct ws_group      *group;    /* 소속 그룹 (없으면 NULL) */
+} ws_group_link_t;
+
+typedef struct ws_group {
+    uint32_t         id;
+    size_t           count;         /* 소속 연결 수 */
+    ws_group_link_t *head;
+    struct ws_group *hnext;         /* 해시 체인 */
+} ws_group_t;
+
+typedef struct {
+    ws_group_t **buckets;
+    size_t       nbuckets;          /* 2의 거듭제곱 */
+    size_t       ngroups;
+} ws_group_map_t;
+
+/* l 을 id 그룹에 추가 (다른 그룹에 있었다면 먼저 뺌). 0 성공, -1 메모리 부족 */
+int ws_group_add(ws_group_map_t *m, uint32_t id, ws_group_link_t *l);
+
+/* 소속 그룹에서 제거 (빈 그룹은 해제) */
+void ws_group_remove(ws_group_map_t *m, ws_group_link_t *l);
+
+ws_group_t *ws_group_find(const ws_group_map_t *m, uint32_t id);
+
+void ws_group_map_free(ws_group_map_t *m);
@@ -1,5 +1,10 @@
+#include "ws_handshake.h"
+
+#include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <openssl/sha.h>
@@ -7,73 +12,189 @@
 static const char *GUID =
     "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
 
-/* HTTP 헤더 추출 */
-static int extract_header(const char *req,
-                          const char *key,
-                          char *out, size_t cap) {
-    const char *p = strcasestr(req, key);
-    if (!p) return 0;
-    p = strchr(p, ':'); if (!p) return 0;
-    p++; while (*p == ' ') ++p;
-    const char *e = strstr(p, "\r\n"); if (!e) return 0;
-    size_t len = (e - p) < cap - 1 ? (size_t)(e - p) : cap - 1;
-    strncpy(out, p, len); out[len] = '\0';
-    return 1;
+static int allow_deflate = 1;
+
+void ws_handshake_config(int permessage_deflate) {
+    allow_deflate = permessage_deflate;
 }
 
-int websocket_handshake(int cli_fd) {
-    char req[4096];
-    ssize_t n;
-    size_t total = 0;
-    // 블로킹 모드에서 헤더 끝까지 수신
-    while ((n = recv(cli_fd, req + total, sizeof(req) - 1 - total, 0)) > 0) {
-        total += n;
-        req[total] = '\0';
-        if (strstr(req, "\r\n\r\n")) break;
+/* 토크나이저가 관심 있는 헤더 값 (buf 내부를 가리킴) */
+typedef struct {
+    const char *key;     size_t key_len;
+    const char *upgrade; size_t upgrade_len;
+    int         deflate;     /* 받아들일 수 있는 permessage-deflate 제안이 있었음 */
+} hs_req_t;
+
+static int name_is(const char *p, size_t n, const char *name) {
+    return strlen(name) == n && strncasecmp(p, name, n) == 0;
+}
+
+static void trim(const char **b, const char **e) {
+    while (*b < *e && (**b == ' ' || **b == '\t')) (*b)++;
+    while (*e > *b && ((*e)[-1] == ' ' || (*e)[-1] == '\t')) (*e)--;
+}
+
+/* permessage-deflate 제안 하나 ("permessage-deflate; a; b=c") 검사.
+ * 우리는 항상 양쪽 no_context_takeover 로 응답하므로 takeover 관련 인자는 모두 수용,
+ * server_max_window_bits 가 15 보다 작으면(공유 압축본을 쓸 수 없음) 거절 */
+static int pmd_offer_ok(const char *p, const char *end) {
+    const char *semi = memchr(p, ';', end - p);
+    const char *te   = semi ? semi : end;
+    const char *tb   = p;
+    trim(&tb, &te);
+    if (!name_is(tb, te - tb, "permessage-deflate")) return 0;
+
+    while (semi) {
+        p    = semi + 1;
+        semi = memchr(p, ';', end - p);
+        const char *pe = semi ? semi : end;
+        const char *eq = memchr(p, '=', pe - p);
+        const char *nb = p, *ne = eq ? eq : pe;
+        trim(&nb, &ne);
+        size_t nl = ne - nb;
+
+        if (name_is(nb, nl, "server_no_context_takeover") ||
+            name_is(nb, nl, "client_no_context_takeover") ||
+            name_is(nb, nl, "client_max_window_bits")) {
+            continue;
+        }
+        if (name_is(nb, nl, "server_max_window_bits")) {
+            if (!eq) return 0;
+            const char *vb = eq + 1, *ve = pe;
+            trim(&vb, &ve);
+            if (ve > vb && *vb == '"') { vb++; if (ve > vb && ve[-1] == '"') ve--; }
+            if (!(ve - vb == 2 && vb[0] == '1' && vb[1] == '5')) return 0;
+            continue;
+        }
+        return 0;                                 // 모르는 인자
     }
-    if (n < 0) {
-        perror("HS recv");
-        return -1;
+    return 1;
+}
+
+/* Sec-WebSocket-Extensions 값: 쉼표로 나뉜 제안 중 하나라도 받아들일 수 있으면 1 */
+static int pmd_accept(const char *v, const char *end) {
+    while (v < end) {
+        const char *comma = memchr(v, ',', end - v);
+        const char *oe    = comma ? comma : end;
+        if (pmd_offer_ok(v, oe)) return 1;
+        v = comma ? comma + 1 : end;
     }
-    if (!strstr(req, "\r\n\r\n")) {
-        // 헤더가 완전히 도착하지 않음
-        return -1;
+    return 0;
+}
+
+/* HTTP 헤더 한 번 훑기: "Name: value\r\n" 을 잘라 필요한 값만 기록 */
+static int parse_request(const char *req, size_t len, hs_req_t *out) {
+    const char *p   = req;
+    const char *end = req + len;
+
+    // 요청 라인
+    if (len < 4 || memcmp(p, "GET ", 4) != 0) return -1;
+    const char *eol = memchr(p, '\n', end - p);
+    if (!eol) return -1;
+    p = eol + 1;
+
+    while (p < end) {
+        eol = memchr(p, '\n', end - p);
+        if (!eol) return -1;
+        const char *le = eol;
+        if (le > p && le[-1] == '\r') le--;
+        if (le == p) break;                       // 빈 줄 = 헤더 끝
+
+        const char *colon = memchr(p, ':', le - p);
+        if (colon) {
+            const char *v  = colon + 1;
+            while (v < le && (*v == ' ' || *v == '\t')) v++;
+            const char *ve = le;
+            while (ve > v && (ve[-1] == ' ' || ve[-1] == '\t')) ve--;
+
+            size_t nlen = colon - p;
+            if (name_is(p, nlen, "Sec-WebSocket-Key")) {
+                out->key = v;     out->key_len = ve - v;
+            } else if (name_is(p, nlen, "Upgrade")) {
+                out->upgrade = v; out->upgrade_len = ve - v;
+            } else if (allow_deflate && !out->deflate &&
+                       name_is(p, nlen, "Sec-WebSocket-Extensions")) {
+                out->deflate = pmd_accept(v, ve);
+            }
+        }
+        p = eol + 1;
     }
+    return 0;
+}
 
-    char key[128];
-    if (!extract_header(req, "Sec-WebSocket-Key", key, sizeof(key))) {
-        return -1;
+/* 새로 받은 구간만 검사해 헤더 끝을 찾음 */
+static int find_header_end(ws_handshake_t *hs) {
+    size_t i = hs->scanned > 3 ? hs->scanned - 3 : 0;
+    for (; i + 3 < hs->len; i++) {
+        if (hs->buf[i] == '\r' && hs->buf[i + 1] == '\n' &&
+            hs->buf[i + 2] == '\r' && hs->buf[i + 3] == '\n') {
+            hs->hdr_len = i + 4;
+            return 1;
+        }
     }
+    hs->scanned = hs->len;
+    return 0;
+}
+
+static int build_response(const hs_req_t *rq, char *res, size_t cap, size_t *res_len) {
+    if (!rq->key || rq->key_len == 0 || rq->key_len > 64) return -1;
+    if (rq->upgrade && !name_is(rq->upgrade, rq->upgrade_len, "websocket")) return -1;
 
     // SHA-1(key + GUID)
-    char concat[256];
-    snprintf(concat, sizeof(concat), "%s%s", key, GUID);
+    char concat[128];
+    int  cl = snprintf(concat, sizeof(concat), "%.*s%s", (int) rq->key_len, rq->key, GUID);
     unsigned char sha1sum[SHA_DIGEST_LENGTH];
-    SHA1((unsigned char *)concat, strlen(concat), sha1sum);
+    SHA1((unsigned char *)concat, (size_t) cl, sha1sum);
 
     // Base64 인코딩
     char accept_key[EVP_ENCODE_LENGTH(SHA_DIGEST_LENGTH) + 1];
     EVP_EncodeBlock((unsigned char *)accept_key, sha1sum, SHA_DIGEST_LENGTH);
 
     // 101 Switching Protocols 응답
-    char res[512];
-    int m = snprintf(res, sizeof(res),
+    int m = snprintf(res, cap,
         "HTTP/1.1 101 Switching Protocols\r\n"
         "Upgrade: websocket\r\n"
         "Connection: Upgrade\r\n"
-        "Sec-WebSocket-Accept: %s\r\n\r\n",
-        accept_key);
-    if (m < 0 || m >= (int)sizeof(res)) return -1;
+        "Sec-WebSocket-Accept: %s\r\n"
+        "%s\r\n",
+        accept_key,
+        rq->deflate ? "Sec-WebSocket-Extensions: permessage-deflate; "
+                      "server_no_context_takeover; client_no_context_takeover\r\n" : "");
+    if (m < 0 || (size_t) m >= cap) return -1;
+    *res_len = (size_t) m;
+    return 0;
+}
+
+int websocket_handshake(ws_handshake_t *hs, int cli_fd,
+                        char *res, size_t cap, size_t *res_len) {
+    if (!hs->buf) {
+        hs->buf = malloc(WS_HS_MAX_REQ);
+        if (!hs->buf) return -1;
+    }
 
-    // 디버깅용 로그
-    printf("=== WebSocket Handshake Request ===\n%s\n", req);
-    printf("=== WebSocket Handshake Response ===\n%.*s\n", m, res);
+    // 논블로킹: 지금 도착한 만큼만 누적
+    for (;;) {
+        if (hs->len == WS_HS_MAX_REQ) return -1;   // 크기 초과
+        ssize_t n = recv(cli_fd, hs->buf + hs->len, WS_HS_MAX_REQ - hs->len, 0);
+        if (n == 0) return -1;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -1;
+        }
+        hs->len += (size_t) n;
+        if (find_header_end(hs)) break;
+    }
 
-    ssize_t w = write(cli_fd, res, m);
-    if (w != m) {
-        perror("HS write");
-        fflush("stdout");
-    };
+    hs_req_t rq = {0};
+    if (parse_request(hs->buf, hs->hdr_len, &rq) != 0) return -1;
+    if (build_response(&rq, res, cap, res_len) != 0)   return -1;
+    hs->deflate = rq.deflate;
+    return 1;
+}
 
-    return 0;
+void ws_handshake_free(ws_handshake_t *hs) {
+    free(hs->buf);
+    hs->buf = NULL;
+    hs->len = hs->scanned = hs->hdr_len = 0;
 }
@@ -1,2 +1,25 @@
 #pragma once
-int websocket_handshake(int cli_fd);
\ No newline at end of file
+#include <stddef.h>
+
+#define WS_HS_MAX_REQ  4096   /* 업그레이드 요청 헤더 최대 크기 */
+#define WS_HS_TIMEOUT  5      /* 요청 완성까지 허용 시간 (초) */
+
+/* 커넥션별 핸드셰이크 진행 상태 */
+typedef struct {
+    char   *buf;        /* 요청 누적 버퍼 (WS_HS_MAX_REQ, 지연 할당) */
+    size_t  len;        /* 누적 바이트 */
+    size_t  scanned;    /* 헤더 끝(\r\n\r\n) 탐색을 재개할 위치 */
+    size_t  hdr_len;    /* 헤더 끝 위치 (완료 후 유효) */
+    int     deflate;    /* permessage-deflate 협상됨 (완료 후 유효) */
+} ws_handshake_t;
+
+/* 읽을 수 있는 만큼 읽고 요청이 완성되면 101 응답을 res 에 작성
+ * 1: 완료, 0: 데이터 더 필요(EAGAIN), -1: 실패 (크기 초과, 형식 오류, EOF)
+ * 완료 후 hs->buf[hs->hdr_len .. hs->len) 은 이미 도착한 첫 프레임 바이트 */
+int websocket_handshake(ws_handshake_t *hs, int cli_fd,
+                        char *res, size_t cap, size_t *res_len);
+
+void ws_handshake_free(ws_handshake_t *hs);
+
+/* permessage-deflate 제안을 받아들일지 (기본 1) */
+void ws_handshake_config(int permessage_deflate);
@@ -0,0 +1,178 @@
+#include "ws_json.h"
+#include <string.h>
+
+// 이스케이프가 필요한 바이트: 0 그대로, 1 짧은 이스케이프, 2 \u00XX
+static const uint8_t esc_kind[256] = {
+    [0x00] = 2, [0x01] = 2, [0x02] = 2, [0x03] = 2, [0x04] = 2, [0x05] = 2, [0x06] = 2, [0x07] = 2,
+    [0x08] = 1, [0x09] = 1, [0x0A] = 1, [0x0B] = 2, [0x0C] = 1, [0x0D] = 1, [0x0E] = 2, [0x0F] = 2,
+    [0x10] = 2, [0x11] = 2, [0x12] = 2, [0x13] = 2, [0x14] = 2, [0x15] = 2, [0x16] = 2, [0x17] = 2,
+    [0x18] = 2, [0x19] = 2, [0x1A] = 2, [0x1B] = 2, [0x1C] = 2, [0x1D] = 2, [0x1E] = 2, [0x1F] = 2,
+    ['"']  = 1, ['\\'] = 1,
+};
+
+static const char digits2[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+size_t ws_itoa(int64_t v, char *out) {
+    char     tmp[20];
+    char    *p = tmp + sizeof tmp;
+    uint64_t u = v < 0 ? 0 - (uint64_t) v : (uint64_t) v;
+
+    // 뒤에서부터 두 자리씩
+    while (u >= 100) {
+        unsigned d = (unsigned) (u % 100) * 2;
+        u /= 100;
+        *--p = digits2[d + 1];
+        *--p = digits2[d];
+    }
+    if (u >= 10) {
+        unsigned d = (unsigned) u * 2;
+        *--p = digits2[d + 1];
+        *--p = digits2[d];
+    } else {
+        *--p = (char) ('0' + u);
+    }
+    size_t n = 0;
+    if (v < 0) out[n++] = '-';
+    size_t dn = (size_t) (tmp + sizeof tmp - p);
+    memcpy(out + n, p, dn);
+    return n + dn;
+}
+
+// 쓸 자리 n 바이트 확보: 쓸 위치, 실패하면 NULL
+static char *reserve(ws_jw_t *w, size_t n) {
+    if (w->failed) return NULL;
+    if (w->len + n > w->m->cap) {
+        size_t cap = w->m->cap * 2;
+        if (cap < w->len + n) cap = w->len + n;
+        ws_msg_t *g = ws_msg_grow(w->m, cap);
+        if (!g) {
+            w->failed = 1;
+            return NULL;
+        }
+        w->m = g;
+    }
+    return (char *) ws_msg_payload(w->m) + w->len;
+}
+
+static void put(ws_jw_t *w, const char *s, size_t n) {
+    char *d = reserve(w, n);
+    if (!d) return;
+    memcpy(d, s, n);
+    w->len += n;
+}
+
+static void put_c(ws_jw_t *w, char c) {
+    char *d = reserve(w, 1);
+    if (!d) return;
+    *d = c;
+    w->len++;
+}
+
+// ,"key":
+static void put_key(ws_jw_t *w, const char *key) {
+    size_t kn = strlen(key);
+    char *d = reserve(w, kn + 4);
+    if (!d) return;
+    size_t n = 0;
+    if (w->comma) d[n++] = ',';
+    d[n++] = '"';
+    memcpy(d + n, key, kn);
+    n += kn;
+    d[n++] = '"';
+    d[n++] = ':';
+    w->len  += n;
+    w->comma = 1;
+}
+
+void ws_jw_begin(ws_jw_t *w, size_t hint) {
+    w->m      = ws_msg_new(hint ? hint : 64);
+    w->len    = 0;
+    w->comma  = 0;
+    w->failed = w->m == NULL;
+}
+
+void ws_jw_object_begin(ws_jw_t *w) {
+    if (w->comma) put_c(w, ',');
+    put_c(w, '{');
+    w->comma = 0;
+}
+
+void ws_jw_object_end(ws_jw_t *w) {
+    put_c(w, '}');
+    w->comma = 1;
+}
+
+void ws_jw_array_begin(ws_jw_t *w, const char *key) {
+    put_key(w, key);
+    put_c(w, '[');
+    w->comma = 0;
+}
+
+void ws_jw_array_end(ws_jw_t *w) {
+    put_c(w, ']');
+    w->comma = 1;
+}
+
+void ws_jw_str(ws_jw_t *w, const char *key, const char *s, size_t n) {
+    put_key(w, key);
+    put_c(w, '"');
+
+    // 이스케이프 없는 구간은 통째로 복사
+    const uint8_t *p = (const uint8_t *) s, *e = p + n, *run = p;
+    for (; p < e; p++) {
+        uint8_t k = esc_kind[*p];
+        if (!k) continue;
+        put(w, (const char *) run, (size_t) (p - run));
+        run = p + 1;
+        if (k == 1) {
+            char c;
+            switch (*p) {
+            case '\b': c = 'b'; break;
+            case '\t': c = 't'; break;
+            case '\n': c = 'n'; break;
+            case '\f': c = 'f'; break;
+            case '\r': c = 'r'; break;
+            default:   c = (char) *p; break;   // " \ 그대로
+            }
+            char esc[2] = { '\\', c };
+            put(w, esc, 2);
+        } else {
+            static const char hex[] = "0123456789abcdef";
+            char esc[6] = { '\\', 'u', '0', '0', hex[*p >> 4], hex[*p & 0xF] };
+            put(w, esc, 6);
+        }
+    }
+    put(w, (const char *) run, (size_t) (e - run));
+    put_c(w, '"');
+}
+
+void ws_jw_int(ws_jw_t *w, const char *key, int64_t v) {
+    put_key(w, key);
+    char *d = reserve(w, 20);
+    if (!d) return;
+    w->len += ws_itoa(v, d);
+}
+
+void ws_jw_elem_int(ws_jw_t *w, int64_t v) {
+    char *d = reserve(w, 21);
+    if (!d) return;
+    size_t n = 0;
+    if (w->comma) d[n++] = ',';
+    n += ws_itoa(v, d + n);
+    w->len  += n;
+    w->comma = 1;
+}
+
+ws_msg_t *ws_jw_finish(ws_jw_t *w) {
+    ws_msg_t *m = w->m;
+    w->m = NULL;
+    if (w->failed) {
+        if (m) ws_msg_unref(m);
+        return NULL;
+    }
+    ws_msg_seal(m, WS_OP_TEXT, w->len);
+    return m;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "ws_frame.h"
+
+/* ---------- 스트리밍 JSON 작성기 ----------
+ * 공유 프레임(ws_msg_t) payload 자리에 바로 써 나가고, 끝나면 헤드룸에 헤더만 붙여 봉인한다.
+ * DOM/중간 문자열이 없어 이벤트 하나에 할당은 프레임 한 번 (모자라면 두 배로 늘림).
+ * 키는 호출자가 넘기는 리터럴이라 이스케이프하지 않는다. 할당 실패는 끝까지 미뤄
+ * ws_jw_finish 가 NULL 을 돌려준다. */
+
+typedef struct {
+    ws_msg_t *m;
+    size_t    len;      /* 쓴 payload 바이트 */
+    int       comma;    /* 다음 값 앞에 ',' 필요 */
+    int       failed;
+} ws_jw_t;
+
+/* hint: 예상 payload 크기 (모자라면 자라므로 대략이면 됨) */
+void ws_jw_begin(ws_jw_t *w, size_t hint);
+
+void ws_jw_object_begin(ws_jw_t *w);
+void ws_jw_object_end(ws_jw_t *w);
+void ws_jw_array_begin(ws_jw_t *w, const char *key);   /* "key":[ */
+void ws_jw_array_end(ws_jw_t *w);
+
+void ws_jw_str(ws_jw_t *w, const char *key, const char *s, size_t n);   /* "key":"s" (이스케이프) */
+void ws_jw_int(ws_jw_t *w, const char *key, int64_t v);                 /* "key":v */
+void ws_jw_elem_int(ws_jw_t *w, int64_t v);                             /* 배열 원소 */
+
+/* text 프레임으로 봉인해 돌려줌 (refcnt = 1). 중간에 실패했으면 NULL */
+ws_msg_t *ws_jw_finish(ws_jw_t *w);
+
+/* 정수 → 10진 문자열 (printf 없이, NUL 없음). 쓴 바이트 수, out 은 20바이트 이상 */
+size_t ws_itoa(int64_t v, char *out);
@@ -0,0 +1,80 @@
+#include "ws_mailbox.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+int ws_mailbox_init(ws_mailbox_t *mb) {
+    pthread_mutex_init(&mb->mtx, NULL);
+    mb->head = mb->tail = NULL;
+    mb->posted = 0;
+    mb->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return mb->efd < 0 ? -1 : 0;
+}
+
+void ws_mailbox_destroy(ws_mailbox_t *mb) {
+    ws_task_t *t = mb->head;
+    while (t) {
+        ws_task_t *n = t->next;
+        if (!t->embedded) free(t);
+        t = n;
+    }
+    mb->head = mb->tail = NULL;
+    if (mb->efd >= 0) close(mb->efd);
+    mb->efd = -1;
+    pthread_mutex_destroy(&mb->mtx);
+}
+
+static void enqueue(ws_mailbox_t *mb, ws_task_t *t) {
+    t->next = NULL;
+
+    pthread_mutex_lock(&mb->mtx);
+    int was_empty = (mb->head == NULL);
+    if (mb->tail) mb->tail->next = t;
+    else          mb->head = t;
+    mb->tail = t;
+    mb->posted++;
+    pthread_mutex_unlock(&mb->mtx);
+
+    // 비어 있다 채워질 때만 깨움 (이미 대기 중인 알림이 있으면 생략)
+    if (was_empty) {
+        uint64_t one = 1;
+        ssize_t w = write(mb->efd, &one, sizeof one);
+        (void) w;
+    }
+}
+
+int ws_mailbox_post(ws_mailbox_t *mb, ws_task_fn fn, void *arg) {
+    ws_task_t *t = malloc(sizeof *t);
+    if (!t) return -1;
+    t->fn       = fn;
+    t->arg      = arg;
+    t->embedded = 0;
+    enqueue(mb, t);
+    return 0;
+}
+
+void ws_mailbox_post_task(ws_mailbox_t *mb, ws_task_t *t) {
+    t->embedded = 1;
+    enqueue(mb, t);
+}
+
+void ws_mailbox_drain(ws_mailbox_t *mb) {
+    uint64_t cnt;
+    ssize_t r = read(mb->efd, &cnt, sizeof cnt);
+    (void) r;
+
+    pthread_mutex_lock(&mb->mtx);
+    ws_task_t *t = mb->head;
+    mb->head = mb->tail = NULL;
+    pthread_mutex_unlock(&mb->mtx);
+
+    while (t) {
+        // 내장 노드는 fn 안에서 소유 구조체와 함께 해제될 수 있으니 먼저 읽어 둠
+        ws_task_t *n = t->next;
+        int embedded = t->embedded;
+        t->fn(t->arg);
+        if (!embedded) free(t);
+        t = n;
+    }
+}
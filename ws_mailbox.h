@@ -0,0 +1,34 @@
+#pragma once
+#include <pthread.h>
+
+/* ---------- 스레드 간 작업 전달 ----------
+ * 다른 스레드가 작업(fn, arg)을 넣고 eventfd 로 깨우면,
+ * 소유 reactor 가 epoll 에서 알림을 받아 자기 스레드에서 실행한다. */
+typedef void (*ws_task_fn)(void *arg);
+
+typedef struct ws_task {
+    ws_task_fn      fn;
+    void           *arg;
+    struct ws_task *next;
+    int             embedded;  /* 호출자 구조체에 내장된 노드 (drain 이 free 하지 않음) */
+} ws_task_t;
+
+typedef struct {
+    pthread_mutex_t mtx;
+    ws_task_t      *head, *tail;
+    int             efd;       /* epoll 에 등록할 eventfd */
+    unsigned long   posted;    /* 누적 작업 수 (통계) */
+} ws_mailbox_t;
+
+int  ws_mailbox_init(ws_mailbox_t *mb);
+void ws_mailbox_destroy(ws_mailbox_t *mb);
+
+/* 어느 스레드에서나 호출 가능. 0 성공, -1 메모리 부족 */
+int ws_mailbox_post(ws_mailbox_t *mb, ws_task_fn fn, void *arg);
+
+/* 할당 없이 호출자 소유 노드로 전달 (실패 없음). t->fn/arg 를 채워서 넘기고,
+ * fn 이 실행될 때까지 노드를 유지해야 한다. 완료 통지처럼 잃으면 안 되는 작업용 */
+void ws_mailbox_post_task(ws_mailbox_t *mb, ws_task_t *t);
+
+/* 소유 스레드에서 호출: eventfd 를 비우고 쌓인 작업을 순서대로 실행 */
+void ws_mailbox_drain(ws_mailbox_t *mb);
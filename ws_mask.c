@@ -0,0 +1,136 @@
+#include "ws_mask.h"
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WS_MASK_X86 1
+#endif
+
+/* key32 는 메모리상 key[0..3] 순서 그대로 읽은 값 (바이트 순서 무관하게 XOR 이 맞음) */
+
+static void mask_scalar(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key32) {
+    uint8_t k[4];
+    memcpy(k, &key32, 4);
+    for (size_t i = 0; i < len; i++) dst[i] = src[i] ^ k[i & 3];
+}
+
+// 8바이트 단위. 길이가 4의 배수가 아니어도 꼬리는 바이트 단위로
+static void mask_word64(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key32) {
+    uint64_t k64 = ((uint64_t) key32 << 32) | key32;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t v;
+        memcpy(&v, src + i, 8);
+        v ^= k64;
+        memcpy(dst + i, &v, 8);
+    }
+    mask_scalar(dst + i, src + i, len - i, key32);   // i 는 4의 배수라 키 위상 유지
+}
+
+#ifdef WS_MASK_X86
+__attribute__((target("sse2")))
+static void mask_sse2(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key32) {
+    __m128i k = _mm_set1_epi32((int) key32);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i b = _mm_loadu_si128((const __m128i *) (src + i + 16));
+        __m128i c = _mm_loadu_si128((const __m128i *) (src + i + 32));
+        __m128i d = _mm_loadu_si128((const __m128i *) (src + i + 48));
+        _mm_storeu_si128((__m128i *) (dst + i),      _mm_xor_si128(a, k));
+        _mm_storeu_si128((__m128i *) (dst + i + 16), _mm_xor_si128(b, k));
+        _mm_storeu_si128((__m128i *) (dst + i + 32), _mm_xor_si128(c, k));
+        _mm_storeu_si128((__m128i *) (dst + i + 48), _mm_xor_si128(d, k));
+    }
+    for (; i + 16 <= len; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (src + i));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_xor_si128(a, k));
+    }
+    mask_word64(dst + i, src + i, len - i, key32);
+}
+
+__attribute__((target("avx2")))
+static void mask_avx2(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key32) {
+    __m256i k = _mm256_set1_epi32((int) key32);
+    size_t i = 0;
+    for (; i + 128 <= len; i += 128) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *) (src + i + 32));
+        __m256i c = _mm256_loadu_si256((const __m256i *) (src + i + 64));
+        __m256i d = _mm256_loadu_si256((const __m256i *) (src + i + 96));
+        _mm256_storeu_si256((__m256i *) (dst + i),      _mm256_xor_si256(a, k));
+        _mm256_storeu_si256((__m256i *) (dst + i + 32), _mm256_xor_si256(b, k));
+        _mm256_storeu_si256((__m256i *) (dst + i + 64), _mm256_xor_si256(c, k));
+        _mm256_storeu_si256((__m256i *) (dst + i + 96), _mm256_xor_si256(d, k));
+    }
+    for (; i + 32 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *) (src + i));
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_xor_si256(a, k));
+    }
+    // 꼬리도 VEX 인코딩으로 처리 (레거시 SSE 함수로 넘어가면 전환 비용이 든다)
+    if (i + 16 <= len) {
+        __m128i a = _mm_loadu_si128((const __m128i *) (src + i));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_xor_si128(a, _mm256_castsi256_si128(k)));
+        i += 16;
+    }
+    _mm256_zeroupper();
+    mask_word64(dst + i, src + i, len - i, key32);
+}
+#endif
+
+static ws_mask_impl_t impls[5];
+static ws_mask_fn     best = mask_word64;
+static const char    *best_name = "word64";
+
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+static void detect(void) {
+    int n = 0;
+    impls[n++] = (ws_mask_impl_t) { "scalar", mask_scalar };
+    impls[n++] = (ws_mask_impl_t) { "word64", mask_word64 };
+#ifdef WS_MASK_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        impls[n++] = (ws_mask_impl_t) { "sse2", mask_sse2 };
+        best = mask_sse2;
+        best_name = "sse2";
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        impls[n++] = (ws_mask_impl_t) { "avx2", mask_avx2 };
+        best = mask_avx2;
+        best_name = "avx2";
+    }
+#endif
+    impls[n] = (ws_mask_impl_t) { NULL, NULL };
+}
+
+const ws_mask_impl_t *ws_mask_impls(void) {
+    pthread_once(&once, detect);
+    return impls;
+}
+
+const char *ws_mask_impl_name(void) {
+    pthread_once(&once, detect);
+    return best_name;
+}
+
+// 짧은 payload (채팅 대부분) 는 분기/호출 비용이 더 커서 바로 바이트 단위로
+#define SMALL_LEN 16
+
+void ws_mask_copy(uint8_t *dst, const uint8_t *src, size_t len,
+                  const uint8_t key[4], size_t phase) {
+    // 위상을 키 회전으로 흡수: 이후로는 항상 0 위상에서 시작
+    uint8_t k[4] = {
+        key[phase & 3], key[(phase + 1) & 3], key[(phase + 2) & 3], key[(phase + 3) & 3],
+    };
+    uint32_t key32;
+    memcpy(&key32, k, 4);
+
+    if (len < SMALL_LEN) {
+        mask_scalar(dst, src, len, key32);
+        return;
+    }
+    pthread_once(&once, detect);
+    best(dst, src, len, key32);
+}
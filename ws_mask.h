@@ -0,0 +1,24 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------- 마스킹 / 언마스킹 ----------
+ * dst[i] = src[i] ^ key[(phase + i) & 3]
+ * phase 는 payload 안에서 src 가 시작하는 위치 (조각으로 나눠 받을 때 이어서 처리).
+ * dst == src 면 제자리 처리. CPU 기능(AVX2/SSE2)은 처음 호출할 때 한 번 검사한다. */
+void ws_mask_copy(uint8_t *dst, const uint8_t *src, size_t len,
+                  const uint8_t key[4], size_t phase);
+
+/* 벤치마크/검증용 개별 구현 (없는 경로는 NULL) */
+typedef void (*ws_mask_fn)(uint8_t *dst, const uint8_t *src, size_t len, uint32_t key32);
+
+typedef struct {
+    const char *name;
+    ws_mask_fn  fn;
+} ws_mask_impl_t;
+
+/* 이 CPU 에서 쓸 수 있는 구현 목록 (마지막은 name == NULL) */
+const ws_mask_impl_t *ws_mask_impls(void);
+
+/* 선택된 구현 이름 */
+const char *ws_mask_impl_name(void);
@@ -0,0 +1,83 @@
+/* 언마스킹 구현별 처리량 (GB/s) 측정
+ * 사용법: ws_mask_bench [payload 바이트 (기본 4096)] [총 MiB (기본 2048)] */
+#include "ws_mask.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/* 기존 ws_recv() 의 바이트 단위 루프 (비교 기준) */
+static void baseline(uint8_t *payload, size_t len, const uint8_t mkey[4]) {
+    for (size_t i = 0; i < len; i++) payload[i] ^= mkey[i & 3];
+}
+
+int main(int argc, char **argv) {
+    size_t len   = argc > 1 ? strtoul(argv[1], NULL, 10) : 4096;
+    size_t total = (argc > 2 ? strtoul(argv[2], NULL, 10) : 2048) << 20;
+    if (len == 0 || len > ((size_t) 1 << 30)) len = 4096;
+    size_t iters = total / len ? total / len : 1;
+
+    // 정렬되지 않은 시작 주소도 섞이도록 +1
+    uint8_t *src = malloc(len + 64), *dst = malloc(len + 64), *ref = malloc(len + 64);
+    if (!src || !dst || !ref) return 1;
+    for (size_t i = 0; i < len + 64; i++) src[i] = (uint8_t) (i * 31 + 7);
+    const uint8_t key[4] = { 0x37, 0xFA, 0x21, 0x3D };
+    uint32_t key32;
+    memcpy(&key32, key, 4);
+
+    // 정확성: 모든 구현이 기준과 같은지
+    memcpy(ref, src + 1, len);
+    baseline(ref, len, key);
+
+    printf("payload=%zu bytes, total=%zu MiB, selected=%s\n", len, total >> 20, ws_mask_impl_name());
+
+    double t0 = now_sec();
+    for (size_t n = 0; n < iters; n++) {
+        baseline(src + 1, len, key);
+        __asm__ volatile("" ::: "memory");
+    }
+    double base = (double) iters * (double) len / (now_sec() - t0) / 1e9;
+    printf("  %-10s %7.2f GB/s\n", "baseline", base);
+
+    // 제자리 XOR 가 홀수 번이면 src 가 마스킹된 상태로 남으니 원본으로 되돌림
+    if (iters % 2) baseline(src + 1, len, key);
+
+    for (const ws_mask_impl_t *im = ws_mask_impls(); im->name; im++) {
+        im->fn(dst, src + 1, len, key32);
+        if (memcmp(dst, ref, len) != 0) {
+            printf("  %-10s MISMATCH\n", im->name);
+            return 1;
+        }
+        t0 = now_sec();
+        for (size_t n = 0; n < iters; n++) {
+            im->fn(dst, src + 1, len, key32);
+            __asm__ volatile("" ::: "memory");
+        }
+        double gbs = (double) iters * (double) len / (now_sec() - t0) / 1e9;
+        printf("  %-10s %7.2f GB/s  (x%.1f)\n", im->name, gbs, gbs / base);
+    }
+
+    ws_mask_copy(dst, src + 1, len, key, 0);
+    if (memcmp(dst, ref, len) != 0) {
+        printf("  %-10s MISMATCH\n", "ws_mask_copy");
+        return 1;
+    }
+    t0 = now_sec();
+    for (size_t n = 0; n < iters; n++) {
+        ws_mask_copy(dst, src + 1, len, key, n);
+        __asm__ volatile("" ::: "memory");
+    }
+    double gbs = (double) iters * (double) len / (now_sec() - t0) / 1e9;
+    printf("  %-10s %7.2f GB/s  (x%.1f)\n", "ws_mask_copy", gbs, gbs / base);
+
+    free(src);
+    free(dst);
+    free(ref);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "ws_outq.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define OUTQ_INIT_CAP 8
+#define OUTQ_IOV_MAX  64    /* writev() 한 번에 묶을 프레임 수 */
+
+static int push(ws_outq_t *q, ws_msg_t *m, size_t off) {
+    if (q->frames == q->cap) {
+        size_t ncap = q->cap ? q->cap * 2 : OUTQ_INIT_CAP;
+        ws_outq_ent_t *nr = malloc(ncap * sizeof *nr);
+        if (!nr) return -1;
+        // 링을 펼쳐서 새 배열 앞쪽으로
+        for (size_t i = 0; i < q->frames; i++) {
+            nr[i] = q->ring[(q->head + i) & (q->cap - 1)];
+        }
+        free(q->ring);
+        q->ring = nr;
+        q->cap  = ncap;
+        q->head = 0;
+    }
+
+    ws_outq_ent_t *e = &q->ring[(q->head + q->frames) & (q->cap - 1)];
+    e->msg = ws_msg_ref(m);
+    e->off = off;
+    q->frames++;
+    q->bytes += m->len - off;
+    if (q->bytes > q->peak) q->peak = q->bytes;
+    return 0;
+}
+
+static void pop(ws_outq_t *q) {
+    ws_msg_unref(q->ring[q->head].msg);
+    q->head = (q->head + 1) & (q->cap - 1);
+    q->frames--;
+}
+
+int ws_outq_send(ws_outq_t *q, int fd, ws_msg_t *m) {
+    size_t off = 0;
+
+    // 앞선 데이터가 남아 있으면 순서를 지키기 위해 그대로 큐잉
+    if (!q->frames) {
+        while (off < m->len) {
+            ssize_t w = write(fd, m->frame + off, m->len - off);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                return -1;
+            }
+            off += (size_t) w;
+        }
+        if (off == m->len) return 0;
+    }
+    return push(q, m, off) < 0 ? -1 : 1;
+}
+
+int ws_outq_flush(ws_outq_t *q, int fd) {
+    while (q->frames) {
+        struct iovec iov[OUTQ_IOV_MAX];
+        int n = 0;
+        for (size_t i = 0; i < q->frames && n < OUTQ_IOV_MAX; i++, n++) {
+            ws_outq_ent_t *e = &q->ring[(q->head + i) & (q->cap - 1)];
+            iov[n].iov_base = e->msg->frame + e->off;
+            iov[n].iov_len  = e->msg->len - e->off;
+        }
+
+        ssize_t w = writev(fd, iov, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 1;
+            return -1;
+        }
+        q->bytes -= (size_t) w;
+
+        // 전송된 만큼 앞에서부터 소비
+        size_t left = (size_t) w;
+        while (left) {
+            ws_outq_ent_t *e = &q->ring[q->head];
+            size_t rem = e->msg->len - e->off;
+            if (left < rem) {
+                e->off += left;
+                break;
+            }
+            left -= rem;
+            pop(q);
+        }
+        if (q->frames && (size_t) w == 0) return 1;
+    }
+    return 0;
+}
+
+void ws_outq_clear(ws_outq_t *q) {
+    while (q->frames) pop(q);
+    free(q->ring);
+    q->ring  = NULL;
+    q->cap   = 0;
+    q->head  = 0;
+    q->bytes = 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "ws_frame.h"
+
+/* ---------- 커넥션별 송신 대기열 ----------
+ * 공유 프레임(ws_msg_t)을 참조로 쌓아두는 링 버퍼. writev() 로 한 번에 비운다. */
+typedef struct {
+    ws_msg_t *msg;
+    size_t    off;     /* 이미 전송한 바이트 */
+} ws_outq_ent_t;
+
+typedef struct {
+    ws_outq_ent_t *ring;
+    size_t         cap;      /* ring 크기 (2의 거듭제곱) */
+    size_t         head;     /* 가장 오래된 항목 */
+    size_t         frames;   /* 대기 중 프레임 수 */
+    size_t         bytes;    /* 미전송 바이트 (큐 깊이) */
+    size_t         peak;     /* bytes 최댓값 */
+    uint64_t       dropped;  /* 워터마크 초과로 버린 프레임 수 */
+} ws_outq_t;
+
+/* 큐가 비어 있으면 바로 write() 하고, 못 보낸 나머지만 참조로 큐잉
+ * 0: 전부 전송, 1: 일부/전부 큐잉됨, -1: 소켓 오류 또는 메모리 부족 */
+int ws_outq_send(ws_outq_t *q, int fd, ws_msg_t *m);
+
+/* 큐에 쌓인 프레임을 writev() 로 가능한 만큼 전송
+ * 0: 큐 비었음, 1: 남아 있음(EAGAIN), -1: 소켓 오류 */
+int ws_outq_flush(ws_outq_t *q, int fd);
+
+void ws_outq_clear(ws_outq_t *q);
@@ -0,0 +1,97 @@
+#include "ws_presence.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+#define PRESENCE_STRIPES  64      /* 잠금 구간 수 */
+#define PRESENCE_BUCKETS  1024    /* 구간별 버킷 수 */
+
+typedef struct pres_ent {
+    uint32_t         room_id, user_id;
+    uint32_t         conns;
+    struct pres_ent *next;
+} pres_ent_t;
+
+typedef struct {
+    pthread_mutex_t mtx;
+    pres_ent_t     *bk[PRESENCE_BUCKETS];
+} pres_stripe_t;
+
+static pres_stripe_t stripes[PRESENCE_STRIPES];
+
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+static void init_stripes(void) {
+    for (int i = 0; i < PRESENCE_STRIPES; i++) {
+        pthread_mutex_init(&stripes[i].mtx, NULL);
+    }
+}
+
+static uint32_t hash(uint32_t room_id, uint32_t user_id) {
+    uint64_t k = ((uint64_t) room_id << 32) | user_id;
+    k *= 0x9E3779B97F4A7C15ull;
+    return (uint32_t) (k >> 32);
+}
+
+#define STRIPE(h) (&stripes[(h) % PRESENCE_STRIPES])
+#define BUCKET(h) (((h) / PRESENCE_STRIPES) % PRESENCE_BUCKETS)
+
+void ws_presence_enter(uint32_t room_id, uint32_t user_id) {
+    pthread_once(&once, init_stripes);
+    uint32_t h = hash(room_id, user_id);
+    pres_stripe_t *s = STRIPE(h);
+
+    pthread_mutex_lock(&s->mtx);
+    pres_ent_t **pp = &s->bk[BUCKET(h)];
+    for (pres_ent_t *e = *pp; e; e = e->next) {
+        if (e->room_id == room_id && e->user_id == user_id) {
+            e->conns++;
+            pthread_mutex_unlock(&s->mtx);
+            return;
+        }
+    }
+    pres_ent_t *e = malloc(sizeof *e);
+    if (e) {
+        e->room_id = room_id;
+        e->user_id = user_id;
+        e->conns   = 1;
+        e->next    = *pp;
+        *pp        = e;
+    }
+    pthread_mutex_unlock(&s->mtx);
+}
+
+void ws_presence_leave(uint32_t room_id, uint32_t user_id) {
+    pthread_once(&once, init_stripes);
+    uint32_t h = hash(room_id, user_id);
+    pres_stripe_t *s = STRIPE(h);
+
+    pthread_mutex_lock(&s->mtx);
+    for (pres_ent_t **pp = &s->bk[BUCKET(h)]; *pp; pp = &(*pp)->next) {
+        pres_ent_t *e = *pp;
+        if (e->room_id == room_id && e->user_id == user_id) {
+            if (--e->conns == 0) {
+                *pp = e->next;
+                free(e);
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s->mtx);
+}
+
+int ws_presence_online(uint32_t room_id, uint32_t user_id) {
+    pthread_once(&once, init_stripes);
+    uint32_t h = hash(room_id, user_id);
+    pres_stripe_t *s = STRIPE(h);
+
+    int found = 0;
+    pthread_mutex_lock(&s->mtx);
+    for (pres_ent_t *e = s->bk[BUCKET(h)]; e; e = e->next) {
+        if (e->room_id == room_id && e->user_id == user_id) {
+            found = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s->mtx);
+    return found;
+}
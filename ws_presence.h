@@ -0,0 +1,13 @@
+#pragma once
+#include <stdint.h>
+
+/* ---------- 방별 접속 현황 (전 reactor 공용) ----------
+ * (room_id, user_id) → 그 방에 들어와 있는 연결 수.
+ * reactor 마다 자기 연결만 알기 때문에, "이 멤버가 지금 방에 있는가"는
+ * 이 표로 판단한다. 잠금은 해시 구간별로 나뉘어 있다. */
+
+void ws_presence_enter(uint32_t room_id, uint32_t user_id);
+void ws_presence_leave(uint32_t room_id, uint32_t user_id);
+
+/* 1: 방에 접속 중인 연결이 있음 */
+int ws_presence_online(uint32_t room_id, uint32_t user_id);
@@ -0,0 +1,390 @@
+#include "ws_request.h"
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_DEPTH 32    /* 건너뛰는 중첩 값의 최대 깊이 (넘으면 cJSON 으로) */
+
+/* 필드 (type 별로 필요한 것만 꺼냄) */
+enum { F_SID = 1, F_ROOM = 2, F_CONTENT = 4 };
+
+static const unsigned char need_fields[] = {
+    [WS_REQ_AUTH]    = F_SID,
+    [WS_REQ_JOIN]    = F_SID | F_ROOM,
+    [WS_REQ_MESSAGE] = F_CONTENT,
+    [WS_REQ_INVALID] = 0,
+};
+
+// type 문자열 → enum : 길이 + 첫 글자로 가르고 memcmp 한 번
+static ws_req_type_t type_of(const char *s, size_t n) {
+    switch (n) {
+    case 4:
+        switch (s[0]) {
+        case 'p': return memcmp(s, "pong", 4) == 0 ? WS_REQ_PONG : WS_REQ_UNKNOWN;
+        case 'a': return memcmp(s, "auth", 4) == 0 ? WS_REQ_AUTH : WS_REQ_UNKNOWN;
+        case 'j': return memcmp(s, "join", 4) == 0 ? WS_REQ_JOIN : WS_REQ_UNKNOWN;
+        }
+        break;
+    case 5:  return memcmp(s, "leave", 5) == 0 ? WS_REQ_LEAVE : WS_REQ_UNKNOWN;
+    case 7:  return memcmp(s, "message", 7) == 0 ? WS_REQ_MESSAGE : WS_REQ_UNKNOWN;
+    case 16: return memcmp(s, "update-chat-room", 16) == 0 ? WS_REQ_UPDATE_ROOMS : WS_REQ_UNKNOWN;
+    }
+    return WS_REQ_UNKNOWN;
+}
+
+// 키 → 필드 (type 은 0x100 으로 따로 표시)
+#define K_TYPE 0x100
+static int key_of(const char *s, size_t n) {
+    switch (n) {
+    case 3: return memcmp(s, "sid", 3) == 0 ? F_SID : 0;
+    case 4:
+        if (memcmp(s, "type", 4) == 0) return K_TYPE;
+        if (memcmp(s, "room", 4) == 0) return F_ROOM;
+        return 0;
+    case 7: return memcmp(s, "content", 7) == 0 ? F_CONTENT : 0;
+    }
+    return 0;
+}
+
+/* ---------- 스캐너: 성공하면 값 다음 위치, 형식 밖이면 NULL ---------- */
+static const char *skip_ws(const char *p, const char *e) {
+    while (p < e && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+    return p;
+}
+
+static int hex4(const char *p, const char *e, unsigned *out) {
+    if (e - p < 4) return -1;
+    unsigned v = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        v <<= 4;
+        if      (c >= '0' && c <= '9') v |= (unsigned) (c - '0');
+        else if (c >= 'a' && c <= 'f') v |= (unsigned) (c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v |= (unsigned) (c - 'A' + 10);
+        else return -1;
+    }
+    *out = v;
+    return 0;
+}
+
+/* p 는 여는 따옴표. 이스케이프(서로게이트 쌍 포함)까지 검사해 두므로 unescape 는 실패하지 않는다 */
+static const char *scan_string(const char *p, const char *e, int *escaped) {
+    *escaped = 0;
+    for (p++; p < e; p++) {
+        if (*p == '"') return p + 1;
+        if ((unsigned char) *p < 0x20) return NULL;   // 이스케이프 안 된 제어 문자: cJSON 과 같게 거절
+        if (*p != '\\') continue;
+        *escaped = 1;
+        if (++p == e) return NULL;
+        switch (*p) {
+        case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+            break;
+        case 'u': {
+            unsigned cp;
+            if (hex4(p + 1, e, &cp) < 0) return NULL;
+            p += 4;
+            // \u0000 은 NUL 로 풀려 길이와 C 문자열이 어긋남: cJSON 에 맡김 (NUL 에서 잘림)
+            if (cp == 0) return NULL;
+            if (cp >= 0xDC00 && cp <= 0xDFFF) return NULL;
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                unsigned lo;
+                if (e - p < 3 || p[1] != '\\' || p[2] != 'u' || hex4(p + 3, e, &lo) < 0) return NULL;
+                if (lo < 0xDC00 || lo > 0xDFFF) return NULL;
+                p += 6;
+            }
+            break;
+        }
+        default:
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static const char *scan_number(const char *p, const char *e) {
+    const char *s = p;
+    if (p < e && *p == '-') p++;
+    if (p == e || *p < '0' || *p > '9') return NULL;
+    while (p < e && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' ||
+                     *p == '+' || *p == '-')) p++;
+    return p > s ? p : NULL;
+}
+
+static const char *scan_value(const char *p, const char *e, int depth) {
+    if (p == e) return NULL;
+    int esc;
+    switch (*p) {
+    case '"': return scan_string(p, e, &esc);
+    case 't': return e - p >= 4 && memcmp(p, "true", 4) == 0 ? p + 4 : NULL;
+    case 'f': return e - p >= 5 && memcmp(p, "false", 5) == 0 ? p + 5 : NULL;
+    case 'n': return e - p >= 4 && memcmp(p, "null", 4) == 0 ? p + 4 : NULL;
+    case '{': case '[': {
+        char close = *p == '{' ? '}' : ']';
+        if (depth >= MAX_DEPTH) return NULL;
+        p = skip_ws(p + 1, e);
+        if (p < e && *p == close) return p + 1;
+        for (;;) {
+            if (close == '}') {
+                if (p == e || *p != '"' || !(p = scan_string(p, e, &esc))) return NULL;
+                p = skip_ws(p, e);
+                if (p == e || *p != ':') return NULL;
+                p = skip_ws(p + 1, e);
+            }
+            if (!(p = scan_value(p, e, depth + 1))) return NULL;
+            p = skip_ws(p, e);
+            if (p == e) return NULL;
+            if (*p == close) return p + 1;
+            if (*p != ',') return NULL;
+            p = skip_ws(p + 1, e);
+        }
+    }
+    default:
+        return scan_number(p, e);
+    }
+}
+
+/* ---------- 제자리 unescape ---------- */
+static size_t put_utf8(char *d, unsigned cp) {
+    if (cp < 0x80)    { d[0] = (char) cp; return 1; }
+    if (cp < 0x800)   { d[0] = (char) (0xC0 | cp >> 6); d[1] = (char) (0x80 | (cp & 0x3F)); return 2; }
+    if (cp < 0x10000) {
+        d[0] = (char) (0xE0 | cp >> 12);
+        d[1] = (char) (0x80 | ((cp >> 6) & 0x3F));
+        d[2] = (char) (0x80 | (cp & 0x3F));
+        return 3;
+    }
+    d[0] = (char) (0xF0 | cp >> 18);
+    d[1] = (char) (0x80 | ((cp >> 12) & 0x3F));
+    d[2] = (char) (0x80 | ((cp >> 6) & 0x3F));
+    d[3] = (char) (0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/* s[0..n) 의 이스케이프를 풀어 s 에 다시 씀 (결과는 항상 n 이하). 새 길이 */
+static size_t unescape(char *s, size_t n) {
+    const char *p = s, *e = s + n;
+    char *d = s;
+    while (p < e) {
+        if (*p != '\\') { *d++ = *p++; continue; }
+        p++;
+        switch (*p++) {
+        case 'b': *d++ = '\b'; break;
+        case 'f': *d++ = '\f'; break;
+        case 'n': *d++ = '\n'; break;
+        case 'r': *d++ = '\r'; break;
+        case 't': *d++ = '\t'; break;
+        case 'u': {
+            unsigned cp, lo;
+            hex4(p, e, &cp);
+            p += 4;
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                hex4(p + 2, e, &lo);
+                p += 6;
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+            }
+            d += put_utf8(d, cp);
+            break;
+        }
+        default: *d++ = p[-1]; break;   // " \ /
+        }
+    }
+    return (size_t) (d - s);
+}
+
+/* ---------- 빠른 경로 ---------- */
+typedef struct {
+    char  *p;       /* 따옴표 안쪽 시작 (문자열) 또는 값 시작 (room) */
+    size_t n;
+    int    escaped;
+    int    is_str;
+} span_t;
+
+// room: 부호 있는 정수만 (실수/지수/범위 밖은 cJSON 의 valueint 규칙으로)
+static int parse_int(const char *p, size_t n, int *out) {
+    size_t i = 0;
+    int neg = 0;
+    if (n && p[0] == '-') { neg = 1; i = 1; }
+    if (i == n) return -1;
+    long v = 0;
+    for (; i < n; i++) {
+        if (p[i] < '0' || p[i] > '9') return -1;
+        v = v * 10 + (p[i] - '0');
+        if (v > (long) INT_MAX + 1) return -1;
+    }
+    if (neg) v = -v;
+    if (v > INT_MAX || v < INT_MIN) return -1;
+    *out = (int) v;
+    return 0;
+}
+
+int ws_req_decode(char *buf, size_t len, ws_req_t *out) {
+    const char *e = buf + len;
+    const char *p = skip_ws(buf, e);
+    span_t type = { 0 }, sid = { 0 }, room = { 0 }, content = { 0 };
+    int seen = 0;
+
+    // 1) 한 번 훑으며 관심 있는 키의 값 위치만 기록 (나머지 값은 건너뜀)
+    if (p == e || *p != '{') return 0;
+    p = skip_ws(p + 1, e);
+    if (p < e && *p == '}') {
+        p++;
+    } else {
+        for (;;) {
+            int esc;
+            if (p == e || *p != '"') return 0;
+            const char *k = p + 1;
+            if (!(p = scan_string(p, e, &esc)) || esc) return 0;   // 이스케이프된 키는 cJSON 으로
+            int key = key_of(k, (size_t) (p - 1 - k));
+            p = skip_ws(p, e);
+            if (p == e || *p != ':') return 0;
+            p = skip_ws(p + 1, e);
+
+            const char *v = p;
+            if (!(p = scan_value(p, e, 1))) return 0;
+            if (key) {
+                if (seen & key) return 0;   // 중복 키: 어느 쪽을 쓸지 cJSON 에 맡김
+                seen |= key;
+                span_t *s = key == K_TYPE ? &type : key == F_SID ? &sid : key == F_ROOM ? &room : &content;
+                s->is_str = *v == '"';
+                if (s->is_str) {
+                    s->p = (char *) v + 1;
+                    s->n = (size_t) (p - 1 - (v + 1));
+                    s->escaped = memchr(s->p, '\\', s->n) != NULL;
+                } else {
+                    s->p = (char *) v;
+                    s->n = (size_t) (p - v);
+                }
+            }
+            p = skip_ws(p, e);
+            if (p == e) return 0;
+            if (*p == '}') { p++; break; }
+            if (*p != ',') return 0;
+            p = skip_ws(p + 1, e);
+        }
+    }
+
+    // 2) type 으로 분기
+    memset(out, 0, sizeof *out);
+    if (!type.is_str) return 1;                   // type 없음/문자열 아님: 무시
+    if (type.escaped) return 0;
+    out->type = type_of(type.p, type.n);
+    if (out->type == WS_REQ_UNKNOWN) return 1;
+
+    // 3) 이 type 이 쓰는 필드만 검사 후 제자리에서 풀어 씀 (검사를 먼저 끝내야 폴백 가능)
+    unsigned need = out->type < sizeof need_fields ? need_fields[out->type] : 0;
+    if ((need & F_SID) && !sid.is_str)         { out->type = WS_REQ_INVALID; return 1; }
+    if ((need & F_CONTENT) && !content.is_str) { out->type = WS_REQ_INVALID; return 1; }
+    if (need & F_ROOM) {
+        if (!room.p || room.is_str || (*room.p != '-' && (*room.p < '0' || *room.p > '9'))) {
+            out->type = WS_REQ_INVALID;
+            return 1;
+        }
+        if (parse_int(room.p, room.n, &out->room) < 0) return 0;
+    }
+    if (need & F_SID) {
+        sid.n = sid.escaped ? unescape(sid.p, sid.n) : sid.n;
+        sid.p[sid.n] = '\0';                      // 닫는 따옴표 자리 (또는 그 앞)
+        out->sid     = sid.p;
+        out->sid_len = sid.n;
+    }
+    if (need & F_CONTENT) {
+        content.n = content.escaped ? unescape(content.p, content.n) : content.n;
+        content.p[content.n] = '\0';
+        out->content     = content.p;
+        out->content_len = content.n;
+    }
+    return 1;
+}
+
+void ws_req_from_json(const cJSON *json, ws_req_t *out) {
+    memset(out, 0, sizeof *out);
+    const cJSON *jt = cJSON_GetObjectItem(json, "type");
+    if (!cJSON_IsString(jt)) return;
+    out->type = type_of(jt->valuestring, strlen(jt->valuestring));
+    if (out->type == WS_REQ_UNKNOWN) return;
+
+    unsigned need = out->type < sizeof need_fields ? need_fields[out->type] : 0;
+    const cJSON *sid     = cJSON_GetObjectItem(json, "sid");
+    const cJSON *room    = cJSON_GetObjectItem(json, "room");
+    const cJSON *content = cJSON_GetObjectItem(json, "content");
+    if (((need & F_SID) && !cJSON_IsString(sid)) ||
+        ((need & F_ROOM) && !cJSON_IsNumber(room)) ||
+        ((need & F_CONTENT) && !cJSON_IsString(content))) {
+        out->type = WS_REQ_INVALID;
+        return;
+    }
+    if (need & F_SID) {
+        out->sid     = sid->valuestring;
+        out->sid_len = strlen(sid->valuestring);
+    }
+    if (need & F_ROOM) out->room = room->valueint;
+    if (need & F_CONTENT) {
+        out->content     = content->valuestring;
+        out->content_len = strlen(content->valuestring);
+    }
+}
+
+/* ---------- cJSON 폴백 파서의 arena ---------- */
+// DOM 은 입력보다 훨씬 커서 (노드당 ~64B + 문자열 복사) 입력 크기의 이 배수까지만 arena 에 맡김
+#define ARENA_EXPANSION 8
+
+static __thread ws_arena_t         *json_arena;    // 이 스레드의 arena (해제 판단용으로 항상 유지)
+static __thread int                 json_active;   // 지금 파싱이 arena 를 쓰는 중
+static __thread unsigned long       json_spilled;  // 이번 파싱에서 힙으로 넘친 할당 수
+static __thread ws_req_json_stats_t json_st;
+
+static void *json_malloc(size_t n) {
+    if (json_active) {
+        void *p = ws_arena_alloc(json_arena, n);
+        if (p) return p;
+        json_spilled++;
+        json_st.spills++;
+    }
+    return malloc(n);
+}
+
+static void json_free(void *p) {
+    if (json_arena && ws_arena_owns(json_arena, p)) return;   // arena 리셋 때 한꺼번에
+    free(p);
+}
+
+void ws_req_json_init(void) {
+    cJSON_Hooks hooks = { .malloc_fn = json_malloc, .free_fn = json_free };
+    cJSON_InitHooks(&hooks);
+}
+
+void ws_req_json_arena(ws_arena_t *a) {
+    json_arena = a;
+}
+
+cJSON *ws_req_parse(const char *buf, size_t len) {
+    json_st.parses++;
+    json_spilled = 0;
+    json_active  = json_arena && len <= json_arena->cap / ARENA_EXPANSION;
+    if (json_arena && !json_active) json_st.heap++;
+
+    cJSON *json = cJSON_ParseWithLength(buf, len);
+    if (!json && json_active) {     // 실패한 파싱의 조각은 cJSON 이 이미 돌려줌
+        ws_arena_reset(json_arena);
+        json_active = 0;
+    }
+    return json;
+}
+
+void ws_req_parse_done(cJSON *json) {
+    if (!json) return;
+    if (!json_active) {
+        cJSON_Delete(json);
+        return;
+    }
+    // 넘친 노드가 있을 때만 트리를 돌아 힙 쪽을 해제 (arena 쪽은 json_free 가 무시)
+    if (json_spilled) cJSON_Delete(json);
+    ws_arena_reset(json_arena);
+    json_active = 0;
+}
+
+void ws_req_json_stats(ws_req_json_stats_t *out) {
+    *out = json_st;
+    out->peak = json_arena ? json_arena->peak : 0;
+}
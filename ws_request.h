@@ -0,0 +1,63 @@
+#pragma once
+#include <stddef.h>
+#include <cjson/cJSON.h>
+#include "ws_arena.h"
+
+/* ---------- 수신 요청 디코더 ----------
+ * 클라이언트 요청은 {"type": ..., 필드...} 한 단계 객체뿐이라 DOM 없이
+ * payload 를 한 번 훑어 type 을 switch 로 가르고, 그 type 이 쓰는 필드만 꺼낸다.
+ * 문자열은 payload 안에서 제자리 unescape + NUL 종료해 가리키므로 복사가 없다.
+ * 빠른 경로가 다루지 않는 모양(이스케이프된 키, 실수 room 등)은 cJSON 으로 넘긴다. */
+
+typedef enum {
+    WS_REQ_UNKNOWN = 0,     /* type 없음/모르는 type: 무시 */
+    WS_REQ_PONG,
+    WS_REQ_AUTH,            /* sid */
+    WS_REQ_JOIN,            /* sid, room */
+    WS_REQ_LEAVE,
+    WS_REQ_MESSAGE,         /* content */
+    WS_REQ_UPDATE_ROOMS,    /* "update-chat-room" */
+    WS_REQ_INVALID          /* 알려진 type 인데 필요한 필드가 없거나 형식이 다름: 무시 */
+} ws_req_type_t;
+
+typedef struct {
+    ws_req_type_t type;
+    const char   *sid;          /* NUL 종료, 없으면 NULL */
+    size_t        sid_len;
+    const char   *content;
+    size_t        content_len;
+    int           room;
+} ws_req_t;
+
+/* 빠른 경로. buf 는 수정 가능해야 함 (디코드한 필드를 제자리에 풀어 씀).
+ * 1 디코드 완료 (out 의 문자열은 buf 를 가리킴), 0 빠른 경로 밖: buf 는 그대로,
+ * ws_req_from_json 으로 처리 */
+int ws_req_decode(char *buf, size_t len, ws_req_t *out);
+
+/* cJSON DOM 에서 같은 결과를 만듦 (out 의 문자열은 json 을 가리킴) */
+void ws_req_from_json(const cJSON *json, ws_req_t *out);
+
+/* ---------- cJSON 폴백 파서의 할당 ----------
+ * cJSON 할당 훅을 스레드별 arena 로 돌린다. 폴백 파싱 한 번의 노드/문자열은
+ * 모두 arena 에 놓이고, 끝나면 트리를 돌지 않고 arena 만 비운다.
+ * arena 가 없는 스레드나 큰 요청(arena 로 모자랄 것 같은 크기)은 그대로 힙을 쓴다. */
+
+/* 훅 설치 (main 에서 스레드 시작 전에 한 번) */
+void ws_req_json_init(void);
+
+/* 이 스레드의 arena 지정 (reactor 시작 시). NULL 이면 힙만 */
+void ws_req_json_arena(ws_arena_t *a);
+
+/* 폴백 파싱: 결과는 반드시 같은 스레드에서 ws_req_parse_done 으로 돌려줌 */
+cJSON *ws_req_parse(const char *buf, size_t len);
+void   ws_req_parse_done(cJSON *json);
+
+typedef struct {
+    unsigned long parses;     /* 폴백 파싱 횟수 */
+    unsigned long heap;       /* 크기 때문에 처음부터 힙으로 간 횟수 */
+    unsigned long spills;     /* arena 가 모자라 힙으로 넘친 할당 수 */
+    size_t        peak;       /* arena 최대 사용량 */
+} ws_req_json_stats_t;
+
+/* 호출한 스레드 기준 */
+void ws_req_json_stats(ws_req_json_stats_t *out);
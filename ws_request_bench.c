@@ -0,0 +1,89 @@
+/* 요청 디코드 비용 (메시지당 ns): cJSON DOM + strcmp 체인 vs ws_req_decode
+ * 사용법: ws_request_bench [반복 횟수 (기본 2000000)] */
+#include "ws_request.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+/* 이전 handle_frame() 의 디스패치: DOM 을 만들고 type 을 strcmp 로 차례로 비교 */
+static int baseline(const char *buf, size_t len) {
+    int hit = 0;
+    cJSON *req = cJSON_ParseWithLength(buf, len);
+    if (!req) return -1;
+    cJSON *jt = cJSON_GetObjectItem(req, "type");
+    if (cJSON_IsString(jt)) {
+        if (strcmp(jt->valuestring, "pong") == 0) {
+            hit = 1;
+        } else if (strcmp(jt->valuestring, "auth") == 0) {
+            hit = cJSON_GetObjectItem(req, "sid")->valuestring[0];
+        } else if (strcmp(jt->valuestring, "join") == 0) {
+            hit = cJSON_GetObjectItem(req, "sid")->valuestring[0] +
+                  cJSON_GetObjectItem(req, "room")->valueint;
+        } else if (strcmp(jt->valuestring, "leave") == 0) {
+            hit = 4;
+        } else if (strcmp(jt->valuestring, "message") == 0) {
+            hit = cJSON_GetObjectItem(req, "content")->valuestring[0];
+        } else if (strcmp(jt->valuestring, "update-chat-room") == 0) {
+            hit = 6;
+        }
+    }
+    cJSON_Delete(req);
+    return hit;
+}
+
+static int fast(char *buf, size_t len) {
+    ws_req_t rq;
+    if (!ws_req_decode(buf, len, &rq)) return -1;
+    switch (rq.type) {
+    case WS_REQ_AUTH:    return rq.sid[0];
+    case WS_REQ_JOIN:    return rq.sid[0] + rq.room;
+    case WS_REQ_MESSAGE: return rq.content[0];
+    default:             return (int) rq.type;
+    }
+}
+
+static const char *samples[][2] = {
+    { "pong",    "{\"type\":\"pong\"}" },
+    { "message", "{\"type\":\"message\",\"content\":\"안녕하세요, 오늘 회의는 3시에 시작합니다. \\\"자료\\\" 미리 봐 주세요!\"}" },
+    { "join",    "{\"type\":\"join\",\"sid\":\"3f9a1c0e5b7d4e2a8c6f1b3d5e7a9c0b\",\"room\":42}" },
+    { "auth",    "{\"type\":\"auth\",\"sid\":\"3f9a1c0e5b7d4e2a8c6f1b3d5e7a9c0b\"}" },
+};
+
+int main(int argc, char **argv) {
+    long iters = argc > 1 ? atol(argv[1]) : 2000000;
+    if (iters <= 0) iters = 2000000;
+    volatile int sink = 0;
+    char buf[512];
+
+    printf("%-8s %12s %12s %8s\n", "request", "cJSON ns", "decode ns", "speedup");
+    for (size_t s = 0; s < sizeof samples / sizeof samples[0]; s++) {
+        const char *js  = samples[s][1];
+        size_t      len = strlen(js);
+
+        // 디코더는 payload 를 제자리에서 고쳐 쓰므로 두 쪽 모두 매번 복사본으로
+        double t0 = now_ns();
+        for (long i = 0; i < iters; i++) {
+            memcpy(buf, js, len);
+            sink += baseline(buf, len);
+        }
+        double base = (now_ns() - t0) / (double) iters;
+
+        t0 = now_ns();
+        for (long i = 0; i < iters; i++) {
+            memcpy(buf, js, len);
+            sink += fast(buf, len);
+        }
+        double dec = (now_ns() - t0) / (double) iters;
+
+        printf("%-8s %12.1f %12.1f %7.1fx\n", samples[s][0], base, dec, base / dec);
+    }
+    (void) sink;
+    return 0;
+}
@@ -1,8 +1,11 @@
 // ws_server.c
 
 #include <errno.h>
+#include <stdatomic.h>
+#include <stddef.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,30 +19,127 @@
 
 #include "ws_handshake.h"
 #include "ws_frame.h"
+#include "ws_group.h"
+#include "ws_mailbox.h"
+#include "ws_outq.h"
+#include "ws_presence.h"
+#include "ws_timer.h"
+#include "ws_conntab.h"
+#include "ws_slab.h"
+#include "ws_bufpool.h"
+#include "ws_deflate.h"
+#include "ws_event.h"
+#include "ws_request.h"
 #include "ws_util.h"
+#include "db_pool.h"
+#include "chat_commit.h"
+#include "chat_unread_cache.h"
+#include "user_cache.h"
+#include "session_cache.h"
+#include "room_member_cache.h"
 #include "session_repository.h"
 #include "chat_repository.h"
 #include "db.h"
 
 #define PORT          8090
 #define MAX_EVENTS    1024
-#define PING_INTERVAL 3    // seconds
-#define PONG_TIMEOUT  3    // seconds
+#define MAX_REACTORS  64   // WS_REACTORS 상한
+#define PING_INTERVAL 3    // seconds (연결마다 시작 시점을 흩어 놓음)
+#define PONG_TIMEOUT  3    // seconds (ping 후 이 안에 아무 프레임이라도 와야 함)
+#define LOOP_WAIT_MS  1000 // 타이머가 없어도 이 주기로 깨어남 (통계 신호 확인)
+
+#define DB_WORKERS    4    // 기본 DB worker 수 (env WS_DB_WORKERS)
+#define CLIENT_POOL_PAGE 64 // client_t 풀 페이지당 칸 수
+#define JSON_ARENA_SIZE  (64 * 1024)   // reactor 별 cJSON arena (env WS_JSON_ARENA)
+#define COMMIT_BATCH     32    // 메시지 그룹 커밋 최대 배치 (env WS_COMMIT_BATCH, 0 = 메시지마다 커밋)
+#define COMMIT_WINDOW_US 2000  // 첫 메시지 후 최대 대기 (env WS_COMMIT_WINDOW_US)
+
+// 송신 큐 워터마크 기본값 (env WS_OUTQ_HIGH / WS_OUTQ_LOW 로 변경)
+#define OUTQ_HIGH_WM  (1024 * 1024)
+#define OUTQ_LOW_WM   (256 * 1024)
 
 typedef struct client {
     int            fd;
     int            handshaked;
+    int            deflate;     // permessage-deflate 협상됨
     uint32_t       user_id;
     int            room_id;
-    time_t         last_pong;
-    struct client *next;
+    char           nick[USER_NICK_MAX];  // auth/join 때 채움 (메시지마다 조회하지 않도록)
+    char           sid[65];     // 검증된 세션 (같은 sid 로 join 하면 재검증 생략)
+    time_t         sid_until;   // 이 시각까지 재검증 없이 신뢰: min(만료, 검증 시각 + 캐시 TTL)
+    uint64_t       last_seen;   // 마지막 수신 시각 (단조 ms)
+    uint64_t       ping_at;     // 마지막 ping 전송 시각
+    int            ping_wait;   // ping 보내고 응답 대기 중
+    ws_timer_t     timer;       // 핸드셰이크 제한 / ping / pong 제한 (하나만 걸림)
+    ws_handshake_t hs;          // 업그레이드 요청 누적 상태
+    ws_reader_t    rd;          // 프레임 수신 버퍼 + 파서 상태
+    ws_outq_t      out;         // 송신 대기열
+    int            want_out;    // EPOLLOUT 등록 여부
+    int            throttled;   // high 워터마크 초과 상태
+    int            closing;     // 지연 해제 예정
+    int            inflight;    // DB 작업 진행 중 (끝날 때까지 다음 프레임 보류)
+    int            refs;        // 진행 중인 DB 작업이 잡고 있는 참조 수
+    int            detached;    // 소켓/인덱스 정리 완료, 참조가 풀리면 해제
+    ws_group_link_t room_link;  // rooms 인덱스 링크
+    ws_group_link_t user_link;  // users 인덱스 링크
+    uint64_t       key;         // epoll 등록 키 (fd + 세대, 연결 표가 발급)
+    struct client *close_next;
 } client_t;
 
-static client_t *clients = NULL;
-static pthread_mutex_t clients_mtx = PTHREAD_MUTEX_INITIALIZER;
+#define ROOM_CLIENT(l) ((client_t *)((char *)(l) - offsetof(client_t, room_link)))
+#define USER_CLIENT(l) ((client_t *)((char *)(l) - offsetof(client_t, user_link)))
+#define TIMER_CLIENT(t) ((client_t *)((char *)(t) - offsetof(client_t, timer)))
+
+// -------------------------------------------------------
+// reactor: 스레드 하나 = listen 소켓(SO_REUSEPORT) + epoll + mailbox.
+// 연결과 방/사용자 인덱스는 소유 reactor 스레드만 만지며,
+// 다른 reactor 의 연결로 보낼 것은 mailbox 로 넘긴다.
+typedef struct reactor {
+    int            id;
+    pthread_t      tid;
+    int            epoll_fd;
+    int            listen_fd;
+    ws_mailbox_t   mbox;        // 다른 스레드에서 넘어온 작업
+    ws_conntab_t   conns;       // fd → 연결 (hot 필드는 연속 배열)
+    ws_slab_t      client_pool; // client_t 할당 풀
+    client_t      *close_list;  // 이벤트 처리 중 닫힌 클라이언트 (루프 끝에서 해제)
+    ws_group_map_t rooms;       // room_id → 이 reactor 의 연결
+    ws_group_map_t users;       // user_id → 이 reactor 의 연결
+    ws_wheel_t     wheel;       // 연결별 heartbeat / timeout 타이머
+    ws_msg_t      *ping_msg;    // 모든 연결이 공유하는 ping 프레임 (0x9 또는 JSON)
+    ws_arena_t     json_arena;  // cJSON 폴백 파싱용 (요청마다 비움)
+    unsigned       stats_seen;
+} reactor_t;
+
+static reactor_t *reactors  = NULL;
+static int        nreactors = 1;
+
+static __thread reactor_t *self = NULL;   // 현재 스레드의 reactor
+
+// 느린 소비자 정책
+static size_t outq_high_wm    = OUTQ_HIGH_WM;
+static size_t outq_low_wm     = OUTQ_LOW_WM;
+static int    slow_disconnect = 1;   // 1: 연결 종료, 0: 프레임 버림
+
+// heartbeat 방식: 0 = 프로토콜 ping(0x9), 1 = {"type":"ping"} JSON (기존 클라이언트 호환)
+static int    json_heartbeat  = 0;
+
+static size_t json_arena_size = JSON_ARENA_SIZE;
 
-// epoll fd 전역 저장
-static int epoll_fd = -1;
+// join 읽음 처리 알림: 묶음 updated-messages / 메시지별 updated-message (env WS_RECEIPTS).
+// 기본은 둘 다: 이전 클라이언트가 모두 묶음 이벤트로 옮겨 간 뒤 "batch" 로 줄인다
+#define RECEIPTS_BATCH  0x1
+#define RECEIPTS_LEGACY 0x2
+static int    receipt_mode    = RECEIPTS_BATCH | RECEIPTS_LEGACY;
+
+// 메시지 INSERT 그룹 커밋 (0 이면 message_work 에서 한 건씩 저장)
+static size_t commit_batch    = COMMIT_BATCH;
+
+static volatile sig_atomic_t stats_gen = 0;
+
+// epoll 키: 연결은 ws_conn_key (fd < 2^31), 그 밖은 fd 자리에 올 수 없는 값
+#define EV_LISTEN  UINT64_MAX
+#define EV_MAILBOX (UINT64_MAX - 1)
 
 // -------------------------------------------------------
 // 논블로킹 소켓 생성
@@ -48,11 +148,12 @@ static int make_nonblock(int fd) {
     return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
 }
 
-// TCP 리스닝 소켓 생성
+// TCP 리스닝 소켓 생성 (reactor 마다 하나, 커널이 SO_REUSEPORT 로 분산)
 static int tcp_listen(int port) {
     int fd = socket(AF_INET, SOCK_STREAM, 0);
     int yes = 1;
     setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes);
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof yes);
     struct sockaddr_in addr = {
         .sin_family      = AF_INET,
         .sin_port        = htons(port),
@@ -63,319 +164,1036 @@ static int tcp_listen(int port) {
     return fd;
 }
 
-// clients 리스트에서 cli 제거
+// 연결 표/인덱스에서 cli 제거
 static void remove_client(client_t *cli) {
-    pthread_mutex_lock(&clients_mtx);
-    client_t **p = &clients;
-    while (*p && *p != cli) p = &(*p)->next;
-    if (*p) *p = cli->next;
-    pthread_mutex_unlock(&clients_mtx);
+    ws_conntab_del(&self->conns, cli->fd);
+    if (cli->room_id > 0 && cli->user_id) {
+        ws_presence_leave((uint32_t) cli->room_id, cli->user_id);
+    }
+    if (cli->user_id) ws_presence_leave(0, cli->user_id);
+    ws_group_remove(&self->rooms, &cli->room_link);
+    ws_group_remove(&self->users, &cli->user_link);
+}
+
+// 방/사용자 인덱스 갱신 (0 = 미소속). 방 접속 현황은 전역 표에도 반영
+static void set_room(client_t *cli, int room) {
+    if (cli->room_id == room) return;
+    if (cli->room_id > 0 && cli->user_id) {
+        ws_presence_leave((uint32_t) cli->room_id, cli->user_id);
+    }
+    cli->room_id = room;
+    ws_conn_hot_t *h = ws_conntab_get(&self->conns, cli->fd);
+    if (h) h->room_id = room;
+    if (room > 0) {
+        ws_group_add(&self->rooms, (uint32_t) room, &cli->room_link);
+        if (cli->user_id) ws_presence_enter((uint32_t) room, cli->user_id);
+    } else {
+        ws_group_remove(&self->rooms, &cli->room_link);
+    }
+}
+
+static void set_user(client_t *cli, uint32_t uid) {
+    if (cli->user_id == uid) return;
+    int room = cli->room_id;
+    set_room(cli, 0);            // 방 접속 현황은 (room, user) 단위라 먼저 정리
+    if (cli->user_id) ws_presence_leave(0, cli->user_id);
+    cli->user_id = uid;
+    if (uid) {
+        ws_group_add(&self->users, uid, &cli->user_link);
+        ws_presence_enter(0, uid);   // room 0 = 방과 무관하게 접속 중
+    } else {
+        ws_group_remove(&self->users, &cli->user_link);
+    }
+    set_room(cli, room);
 }
 
 // -------------------------------------------------------
 // 완전한 연결 해제: epoll, 소켓 닫기, 리스트 제거, 메모리 해제
 static void disconnect_client(client_t *cli) {
-    // 1) epoll에서 제거
-    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, cli->fd, NULL);
+    // 1) epoll, 타이머에서 제거
+    epoll_ctl(self->epoll_fd, EPOLL_CTL_DEL, cli->fd, NULL);
+    ws_timer_cancel(&self->wheel, &cli->timer);
     // 2) 소켓 닫기
     close(cli->fd);
     // 3) 내부 리스트에서 제거
     remove_client(cli);
-    // 4) 메모리 해제
-    free(cli);
+    // 4) 메모리 해제 (DB 작업이 아직 잡고 있으면 끝난 뒤에)
+    ws_handshake_free(&cli->hs);
+    ws_reader_free(&cli->rd);
+    ws_outq_clear(&cli->out);
+    cli->detached = 1;
+    if (cli->refs == 0) ws_slab_free(&self->client_pool, cli);
+}
+
+static client_t *client_hold(client_t *cli) {
+    cli->refs++;
+    return cli;
+}
+
+static void client_release(client_t *cli) {
+    if (--cli->refs == 0 && cli->detached) ws_slab_free(&self->client_pool, cli);
+}
+
+// 핸들러/브로드캐스트 도중에는 바로 해제하지 않고 표시만 해둠
+static void close_later(client_t *cli) {
+    if (cli->closing) return;
+    cli->closing    = 1;
+    ws_conn_hot_t *h = ws_conntab_get(&self->conns, cli->fd);
+    if (h) h->state &= ~WS_CONN_READY;
+    cli->close_next  = self->close_list;
+    self->close_list = cli;
+}
+
+static void reap_closed(void) {
+    while (self->close_list) {
+        client_t *c      = self->close_list;
+        self->close_list = c->close_next;
+        disconnect_client(c);
+    }
 }
 
 // -------------------------------------------------------
-// JSON 전송 헬퍼
-static void send_json(client_t *cli, cJSON *msg) {
-    char *text = cJSON_PrintUnformatted(msg);
-    size_t len  = strlen(text);
-    uint8_t *frame = malloc(len + 16);
-    size_t flen    = ws_build_text_frame((uint8_t*)text, len, frame);
-    writen(cli->fd, frame, flen);
-    free(frame);
-    free(text);
-    cJSON_Delete(msg);
+// 송신 큐 / epoll 관심 이벤트 관리
+// DB 작업 중에는 EPOLLIN 을 빼서 소켓 단에서 자연스럽게 backpressure
+static void update_events(client_t *cli) {
+    struct epoll_event ev = {
+        .events   = (cli->inflight ? 0 : EPOLLIN) | (cli->want_out ? EPOLLOUT : 0),
+        .data.u64 = cli->key,
+    };
+    epoll_ctl(self->epoll_fd, EPOLL_CTL_MOD, cli->fd, &ev);
+}
+
+static void watch_writable(client_t *cli, int on) {
+    if (cli->want_out == on) return;
+    cli->want_out = on;
+    update_events(cli);
 }
 
-// 방 단위 브로드캐스트
-static void broadcast_room(int room, cJSON *msg) {
-    char *text = cJSON_PrintUnformatted(msg);
-    size_t len  = strlen(text);
-    uint8_t *frame = malloc(len + 16);
-    size_t flen    = ws_build_text_frame((uint8_t*)text, len, frame);
-    free(text);
-    cJSON_Delete(msg);
+// 공유 프레임을 큐에 넣음 (참조만 추가). 느린 소비자는 정책에 따라 버리거나 끊음
+static void send_msg(client_t *cli, ws_msg_t *m) {
+    if (cli->closing) return;
+    if (cli->deflate) m = ws_msg_deflated(m);   // 압축본은 프레임당 한 번 만들어 공유
 
-    pthread_mutex_lock(&clients_mtx);
-    for (client_t *c = clients; c; c = c->next) {
-        if (c->handshaked && c->room_id == room) {
-            writen(c->fd, frame, flen);
+    ws_outq_t *q = &cli->out;
+    if (cli->throttled || q->bytes >= outq_high_wm) {
+        if (!cli->throttled) {
+            fprintf(stderr, "WARN: slow consumer fd=%d uid=%u queued=%zu frames=%zu\n",
+                    cli->fd, cli->user_id, q->bytes, q->frames);
         }
+        cli->throttled = 1;
+        q->dropped++;
+        if (slow_disconnect) close_later(cli);
+        return;
     }
-    pthread_mutex_unlock(&clients_mtx);
-    free(frame);
+
+    int rc = ws_outq_send(q, cli->fd, m);
+    if (rc < 0)       close_later(cli);
+    else if (rc > 0)  watch_writable(cli, 1);
 }
 
-// 전체 브로드캐스트
-static void broadcast_all(cJSON *msg) {
-    char *text = cJSON_PrintUnformatted(msg);
-    size_t len = strlen(text);
-    uint8_t *frame = malloc(len + 16);
-    size_t flen  = ws_build_text_frame((uint8_t*)text, len, frame);
-    free(text);
-    cJSON_Delete(msg);
+// EPOLLOUT: 큐 비우기
+static void flush_client(client_t *cli) {
+    int rc = ws_outq_flush(&cli->out, cli->fd);
+    if (rc < 0) {
+        close_later(cli);
+        return;
+    }
+    if (rc == 0) watch_writable(cli, 0);
+    if (cli->throttled && cli->out.bytes <= outq_low_wm) cli->throttled = 0;
+}
+
+// -------------------------------------------------------
+// 이벤트 전송 헬퍼: ws_ev_* 가 만든 프레임의 참조를 넘겨받음 (NULL 이면 무시)
+static void send_event(client_t *cli, ws_msg_t *m) {
+    if (!m) return;
+    send_msg(cli, m);
+    ws_msg_unref(m);
+}
 
-    pthread_mutex_lock(&clients_mtx);
-    for (client_t *c = clients; c; c = c->next) {
-        if (c->handshaked) {
-            writen(c->fd, frame, flen);
+// -------------------------------------------------------
+// 팬아웃: 로컬 연결에 바로 넣고, 다른 reactor 에는 같은 프레임 참조를 넘김
+typedef struct {
+    int       room;     // 0 = 전체
+    ws_msg_t *m;
+} cast_t;
+
+static void fanout_local(int room, ws_msg_t *m) {
+    if (room > 0) {
+        ws_group_t *g = ws_group_find(&self->rooms, (uint32_t) room);
+        for (ws_group_link_t *l = g ? g->head : NULL; l; l = l->next) {
+            send_msg(ROOM_CLIENT(l), m);
         }
+        return;
+    }
+    // 연결 표의 hot 배열만 훑고, 보낼 대상만 client_t 를 건드림
+    for (size_t i = 0; i < self->conns.n; i++) {
+        ws_conn_hot_t *h = &self->conns.hot[i];
+        if (h->state & WS_CONN_READY) send_msg(h->obj, m);
     }
-    pthread_mutex_unlock(&clients_mtx);
-    free(frame);
 }
 
-// Unread 알림
-static void notify_unread(uint32_t room, uint32_t msg_id, uint32_t sender) {
-    pthread_mutex_lock(&clients_mtx);
-    for (client_t *c = clients; c; c = c->next) {
-        if (!c->handshaked)                continue;
-        if ((uint32_t)c->user_id == sender) continue;
-        if (c->room_id == (int)room)       continue;
+static void on_cast(void *arg) {
+    cast_t *c = arg;
+    fanout_local(c->room, c->m);
+    ws_msg_unref(c->m);
+    free(c);
+}
 
-        if (chat_repo_add_unread(msg_id, c->user_id) != 0) {
-            fprintf(stderr, "ERROR: chat_repo_add_unread failed msg=%u uid=%u\n", msg_id, c->user_id);
+static void fanout(int room, ws_msg_t *m) {
+    fanout_local(room, m);
+    for (int i = 0; i < nreactors; i++) {
+        reactor_t *r = &reactors[i];
+        if (r == self) continue;
+        cast_t *c = malloc(sizeof *c);
+        if (!c) continue;
+        c->room = room;
+        c->m    = ws_msg_ref(m);
+        if (ws_mailbox_post(&r->mbox, on_cast, c) < 0) {
+            ws_msg_unref(m);
+            free(c);
         }
+    }
+}
+
+// 방 단위 브로드캐스트: 한 번 직렬화한 프레임을 방 인원 모두가 공유 (참조를 넘겨받음)
+static void broadcast_room(int room, ws_msg_t *m) {
+    if (!m) return;
+    if (room > 0) fanout(room, m);
+    ws_msg_unref(m);
+}
+
+// 전체 브로드캐스트
+static void broadcast_all(ws_msg_t *m) {
+    if (!m) return;
+    fanout(0, m);
+    ws_msg_unref(m);
+}
+
+// Unread 알림: 방 멤버 중 다른 방에 접속해 있는 연결에만.
+// 개수는 DB worker 가 미리 계산해 두고, 모든 reactor 가 목록을 공유해 자기 연결 몫을 보낸다.
+typedef struct {
+    uint32_t user_id;
+    uint32_t count;
+} unread_note_t;
 
-        uint32_t ucnt = 0;
-        if (chat_repo_count_unread(room, c->user_id, &ucnt) != 0) {
-            fprintf(stderr, "ERROR: chat_repo_count_unread failed room=%u uid=%u\n", room, c->user_id);
+typedef struct {
+    atomic_int    refcnt;
+    uint32_t      room;
+    size_t        n;
+    unread_note_t notes[];
+} unread_job_t;
+
+static void notify_unread_local(const unread_job_t *j) {
+    for (size_t i = 0; i < j->n; i++) {
+        ws_group_t *g = ws_group_find(&self->users, j->notes[i].user_id);
+        if (!g) continue;
+
+        ws_msg_t *m = NULL;   // 사용자별 개수 → 그 사용자의 연결끼리 공유
+        for (ws_group_link_t *l = g->head; l; l = l->next) {
+            client_t *c = USER_CLIENT(l);
+            if (!c->handshaked)             continue;
+            if (c->room_id == (int)j->room) continue;
+
+            if (!m && !(m = ws_ev_unread(j->room, j->notes[i].count))) break;
+            send_msg(c, m);
         }
+        ws_msg_unref(m);
+    }
+}
+
+static void unread_job_unref(unread_job_t *j) {
+    if (atomic_fetch_sub_explicit(&j->refcnt, 1, memory_order_acq_rel) == 1) free(j);
+}
+
+static void on_notify_unread(void *arg) {
+    notify_unread_local(arg);
+    unread_job_unref(arg);
+}
 
-        cJSON *n = cJSON_CreateObject();
-        cJSON_AddStringToObject(n, "type",  "unread");
-        cJSON_AddNumberToObject(n, "room",  room);
-        cJSON_AddNumberToObject(n, "count", ucnt);
-        send_json(c, n);
+static void notify_unread(uint32_t room, const unread_note_t *notes, size_t n) {
+    if (n == 0) return;
+    unread_job_t *j = malloc(sizeof *j + n * sizeof *notes);
+    if (!j) return;
+    atomic_init(&j->refcnt, 1);
+    j->room = room;
+    j->n    = n;
+    memcpy(j->notes, notes, n * sizeof *notes);
+
+    for (int i = 0; i < nreactors; i++) {
+        reactor_t *r = &reactors[i];
+        if (r == self) continue;
+        atomic_fetch_add_explicit(&j->refcnt, 1, memory_order_relaxed);
+        if (ws_mailbox_post(&r->mbox, on_notify_unread, j) < 0) unread_job_unref(j);
     }
-    pthread_mutex_unlock(&clients_mtx);
+    notify_unread_local(j);
+    unread_job_unref(j);
 }
 
 // -------------------------------------------------------
-static void handle_client(client_t *cli) {
-    int fd = cli->fd;
+// DB 요청: work() 는 DB worker 스레드, done() 은 이 연결의 reactor 스레드에서 실행.
+// 작업이 끝날 때까지 같은 연결의 다음 프레임은 처리하지 않아 요청 순서가 유지된다.
+static void handle_client(client_t *cli);
+static void close_with(client_t *cli, uint16_t code);
 
-    // 1) WebSocket 핸드셰이크
-    if (!cli->handshaked) {
-        if (websocket_handshake(fd) == 0) {
-            make_nonblock(fd);
-            cli->handshaked = 1;
-            cli->user_id    = 0;
-            cli->room_id    = 0;
-            cli->last_pong  = time(NULL);
-        } else {
-            disconnect_client(cli);
+// 연결을 잡고 수신을 멈춤. 작업은 호출자가 db_pool (또는 앞 단계) 로 넘김
+static void hold_for_job(client_t *cli, db_job_t *job, db_job_fn work, db_job_fn done) {
+    job->work  = work;
+    job->done  = done;
+    job->reply = &self->mbox;
+    client_hold(cli);
+    cli->inflight = 1;
+    update_events(cli);
+}
+
+static void submit_job(client_t *cli, db_job_t *job, db_job_fn work, db_job_fn done) {
+    hold_for_job(cli, job, work, done);
+    db_pool_submit(job);
+}
+
+// done() 마지막에 호출: 보류했던 프레임 처리 재개
+static void finish_job(client_t *cli) {
+    cli->inflight = 0;
+    if (!cli->detached && !cli->closing) {
+        update_events(cli);
+        handle_client(cli);
+    }
+    client_release(cli);
+}
+
+// ---- auth ----
+typedef struct {
+    db_job_t  job;
+    client_t *cli;
+    char      sid[65];
+    int       ok;
+    uint32_t  uid;
+    time_t    exp;
+    char      nick[USER_NICK_MAX];
+} auth_job_t;
+
+static void auth_work(db_job_t *job) {
+    auth_job_t *j = (auth_job_t *) job;
+    j->ok = session_cache_find(j->sid, &j->uid, &j->exp) == 0;
+    if (j->ok) user_cache_nick(j->uid, j->nick, sizeof j->nick);
+}
+
+// 검증된 세션을 연결에 기록. 만료가 없어도 캐시 TTL 이 지나면 다시 확인한다
+static void remember_session(client_t *cli, const char *sid, time_t exp) {
+    memcpy(cli->sid, sid, sizeof cli->sid);
+    cli->sid_until = session_cache_trust_until(exp);
+}
+
+static int session_fresh(const client_t *cli) {
+    return cli->sid[0] && time(NULL) < cli->sid_until;
+}
+
+static int session_valid(const client_t *cli, const char *sid) {
+    return cli->user_id && session_fresh(cli) && strcmp(cli->sid, sid) == 0;
+}
+
+static void auth_done(db_job_t *job) {
+    auth_job_t *j = (auth_job_t *) job;
+    client_t *cli = j->cli;
+    if (j->ok && !cli->closing) {
+        set_user(cli, j->uid);
+        memcpy(cli->nick, j->nick, sizeof cli->nick);
+        remember_session(cli, j->sid, j->exp);
+        send_event(cli, ws_ev_auth_ok());
+    }
+    free(j);
+    finish_job(cli);
+}
+
+// ---- join ----
+typedef struct {
+    db_job_t       job;
+    client_t      *cli;
+    char           sid[65];
+    int            room;
+    int            ok;
+    int            verified;    // 연결에 검증된 세션이 있어 조회 생략
+    uint32_t       uid;
+    time_t         exp;
+    const room_members_t *members;   // joined 브로드캐스트용 (빌린 스냅샷, 없으면 NULL)
+    chat_unread_t *upd;         // 읽음 처리된 메시지별 새 unread 수
+    size_t         upd_cnt;
+    char           nick[USER_NICK_MAX];
+} join_job_t;
+
+static void join_work(db_job_t *job) {
+    join_job_t *j = (join_job_t *) job;
+    if (!j->verified) {
+        if (session_cache_find(j->sid, &j->uid, &j->exp) != 0) return;
+        user_cache_nick(j->uid, j->nick, sizeof j->nick);
+    }
+    j->ok = 1;
+
+    // 읽음 처리될 메시지별 새 unread 수: 지우기 전에 그룹 쿼리 한 번으로.
+    // 근삿값: 조회와 삭제가 한 트랜잭션이 아니라서, 같은 메시지를 읽은 다른 사용자가
+    // 동시에 입장하면 양쪽 모두 상대의 행이 아직 남은 수를 보낼 수 있다 (많아야 동시 입장자 수만큼 큼).
+    // 트랜잭션으로 묶어도 일관 읽기는 상대의 미커밋 삭제를 못 보므로, 정확히 하려면 잠금 읽기로
+    // 입장을 직렬화해야 한다. 그 메시지를 다음에 누가 읽으면 DB 기준으로 다시 계산돼 바로잡힌다.
+    if (chat_repo_get_read_receipts((uint32_t) j->room, j->uid, &j->upd, &j->upd_cnt) != 0) {
+        j->upd     = NULL;
+        j->upd_cnt = 0;
+    }
+
+    chat_repo_clear_unread(j->room, j->uid);
+
+    if (room_members_get_for((uint32_t) j->room, j->uid, &j->members) != 0) j->members = NULL;
+}
+
+static void join_done(db_job_t *job) {
+    join_job_t *j = (join_job_t *) job;
+    client_t *cli = j->cli;
+    int room = j->room;
+
+    if (j->ok && !cli->closing) {
+        // 클라이언트에게 count=0 전송
+        send_event(cli, ws_ev_unread((uint32_t) room, 0));
+
+        // 내부 상태 업데이트
+        if (!j->verified) {
+            set_user(cli, j->uid);
+            memcpy(cli->nick, j->nick, sizeof cli->nick);
+            remember_session(cli, j->sid, j->exp);
+        }
+        set_room(cli, room);
+
+        // joined 브로드캐스트
+        if (j->members) {
+            broadcast_room(room, ws_ev_joined((uint32_t) room, j->members->ids, j->members->n));
         }
-        return;
     }
 
-    // 2) 프레임 수신
-    ws_frame_t f;
-    if (ws_recv(fd, &f) < 0) {
-        disconnect_client(cli);
-        return;
+    // 읽음 처리된 메시지의 새 unread 수 (DB 는 이미 반영됨):
+    // 묶음 이벤트 한 번, 이전 클라이언트용 메시지별 이벤트는 설정에 따라
+    if (j->upd_cnt) {
+        if (receipt_mode & RECEIPTS_BATCH) {
+            broadcast_room(room, ws_ev_updated_messages(j->upd, j->upd_cnt));
+        }
+        if (receipt_mode & RECEIPTS_LEGACY) {
+            for (size_t i = 0; i < j->upd_cnt; i++) {
+                broadcast_room(room, ws_ev_updated_message(j->upd[i].message_id, j->upd[i].count));
+            }
+        }
     }
 
-    // close opcode
-    if (f.opcode == 0x8) {
-        free(f.payload);
-        disconnect_client(cli);
+    room_members_put(j->members);
+    free(j->upd);
+    free(j);
+    finish_job(cli);
+}
+
+// ---- message ----
+typedef struct {
+    db_job_t          job;
+    chat_commit_req_t commit;   // 그룹 커밋 단계 요청 (commit_batch > 0)
+    client_t         *cli;
+    int               room;
+    uint32_t          sender;
+    char             *content;
+    size_t            content_len;
+    int               ok;
+    uint32_t          mid;
+    uint32_t          unread_cnt;
+    char              nick[USER_NICK_MAX];  // 연결에 저장된 값, 비어 있으면 캐시 조회
+    unread_note_t    *notes;      // 다른 방에 접속 중인 멤버별 unread 수
+    size_t            nnotes;
+} msg_job_t;
+
+#define COMMIT_JOB(c) ((msg_job_t *)((char *)(c) - offsetof(msg_job_t, commit)))
+
+// 커밋 스레드: 저장이 끝났으니 unread 처리는 DB worker 로
+static void message_committed(chat_commit_req_t *c) {
+    db_pool_submit(&COMMIT_JOB(c)->job);
+}
+
+static void message_work(db_job_t *job) {
+    msg_job_t *j = (msg_job_t *) job;
+
+    if (commit_batch) {
+        if (j->commit.rc != 0) {
+            fprintf(stderr, "ERROR: group commit failed (rc=%d)\n", j->commit.rc);
+            return;
+        }
+        j->mid = j->commit.message_id;
+    } else if (chat_repo_save_message(j->room, j->sender, j->content, &j->mid) != 0) {
+        fprintf(stderr, "ERROR: chat_repo_save_message failed\n");
         return;
     }
+    j->ok = 1;
 
-    // 3) JSON 파싱
-    cJSON *req = cJSON_ParseWithLength((char*)f.payload, f.len);
-    if (req) {
-        cli->last_pong = time(NULL);
-
-        cJSON *jt = cJSON_GetObjectItem(req, "type");
-        if (cJSON_IsString(jt)) {
-            // pong
-            if (strcmp(jt->valuestring, "pong") == 0) {
-                cJSON_Delete(req);
-                free(f.payload);
-                return;
-            }
-            // auth
-            else if (strcmp(jt->valuestring, "auth") == 0) {
-                const char *sid = cJSON_GetObjectItem(req, "sid")->valuestring;
-                uint32_t uid; time_t exp;
-                if (session_repository_find_id(sid, &uid, &exp) == 0) {
-                    cli->user_id = uid;
-                    cJSON *ok = cJSON_CreateObject();
-                    cJSON_AddStringToObject(ok, "type", "auth_ok");
-                    send_json(cli, ok);
-                }
-                cJSON_Delete(req);
-                free(f.payload);
-                return;
-            }
-            // join
-            else if (strcmp(jt->valuestring, "join") == 0) {
-                const char *sid   = cJSON_GetObjectItem(req, "sid")->valuestring;
-                int          room = cJSON_GetObjectItem(req, "room")->valueint;
-                uint32_t     uid; time_t exp;
-                if (session_repository_find_id(sid, &uid, &exp) == 0) {
-                    // unread 리스트 조회
-                    chat_unread_t *old; size_t old_cnt;
-                    if (chat_repo_get_unread_counts_for_user(room, uid, &old, &old_cnt) != 0) {
-                        old_cnt = 0;
-                    }
-                    uint32_t *msg_ids = NULL;
-                    if (old_cnt > 0) {
-                        msg_ids = malloc(old_cnt * sizeof(uint32_t));
-                        for (size_t i = 0; i < old_cnt; i++) {
-                            msg_ids[i] = old[i].message_id;
-                        }
-                    }
-                    free(old);
-
-                    chat_repo_clear_unread(room, uid);
-
-                    // 클라이언트에게 count=0 전송
-                    {
-                        cJSON *clear = cJSON_CreateObject();
-                        cJSON_AddStringToObject(clear, "type",  "unread");
-                        cJSON_AddNumberToObject(clear, "room",  room);
-                        cJSON_AddNumberToObject(clear, "count", 0);
-                        send_json(cli, clear);
-                    }
-
-                    // 내부 상태 업데이트
-                    cli->user_id = uid;
-                    cli->room_id = room;
-
-                    // joined 브로드캐스트
-                    {
-                        uint32_t *members; size_t mcnt;
-                        if (chat_repo_get_room_members(room, &members, &mcnt) == 0) {
-                            cJSON *res = cJSON_CreateObject();
-                            cJSON_AddStringToObject(res, "type", "joined");
-                            cJSON_AddNumberToObject(res, "room", room);
-                            cJSON *ua = cJSON_AddArrayToObject(res, "users");
-                            for (size_t i = 0; i < mcnt; i++) {
-                                cJSON_AddItemToArray(ua, cJSON_CreateNumber(members[i]));
-                            }
-                            free(members);
-                            broadcast_room(room, res);
-                        }
-                    }
-
-                    // 이전 unread 메시지별 updated-message 전송
-                    if (msg_ids) {
-                        for (size_t i = 0; i < old_cnt; i++) {
-                            uint32_t mid = msg_ids[i];
-                            int new_cnt = chat_repo_get_unread_count_for_message(room, mid);
-                            cJSON *upd = cJSON_CreateObject();
-                            cJSON_AddStringToObject(upd, "type",       "updated-message");
-                            cJSON_AddNumberToObject(upd, "id",         mid);
-                            cJSON_AddNumberToObject(upd, "unread_cnt", new_cnt);
-                            broadcast_room(room, upd);
-                        }
-                        free(msg_ids);
-                    }
-                }
+    // 같은 방에 접속 안 한 멤버에게만 unread 추가 (한 번의 멀티로우 INSERT)
+    static __thread uint32_t *offline;   // worker 스레드별 재사용 버퍼
+    static __thread size_t    offline_cap;
+
+    const room_members_t *rm;
+    if (room_members_get_for((uint32_t) j->room, j->sender, &rm) == 0) {
+        if (rm->n > offline_cap) {
+            uint32_t *p = realloc(offline, rm->n * sizeof *p);
+            if (p) {
+                offline     = p;
+                offline_cap = rm->n;
             }
-            // leave
-            else if (strcmp(jt->valuestring, "leave") == 0) {
-                uint32_t rid = cli->room_id;
-                cli->room_id = 0;
-                cJSON *res = cJSON_CreateObject();
-                cJSON_AddStringToObject(res, "type", "left");
-                cJSON_AddNumberToObject(res, "room", rid);
-                cJSON_AddNumberToObject(res, "user", cli->user_id);
-                broadcast_room(rid, res);
+        }
+        size_t off = 0;
+        for (size_t i = 0; i < rm->n && off < offline_cap; i++) {
+            uint32_t m = rm->ids[i];
+            if (m == j->sender) continue;
+            // 방 접속 여부는 모든 reactor 공용 접속 현황 표로 판단
+            if (ws_presence_online((uint32_t) j->room, m)) continue;
+            offline[off++] = m;
+        }
+        room_members_put(rm);
+
+        if (chat_repo_add_unread_bulk((uint32_t) j->room, j->mid, offline, off) != 0) {
+            fprintf(stderr, "ERROR: chat_repo_add_unread_bulk failed mid=%u n=%zu\n", j->mid, off);
+        }
+
+        // 다른 방에 접속해 있는 멤버에게 보낼 알림용 개수
+        j->notes = malloc((off ? off : 1) * sizeof *j->notes);
+        for (size_t i = 0; j->notes && i < off; i++) {
+            if (!ws_presence_online(0, offline[i])) continue;
+            uint32_t ucnt = 0;
+            if (chat_unread_cache_get((uint32_t) j->room, offline[i], &ucnt) != 0) {
+                fprintf(stderr, "ERROR: chat_unread_cache_get failed room=%d uid=%u\n", j->room, offline[i]);
             }
-            // message
-            else if (strcmp(jt->valuestring, "message") == 0) {
-                const char *ct = cJSON_GetObjectItem(req, "content")->valuestring;
-                uint32_t mid = 0;
-
-                if (chat_repo_save_message(cli->room_id, cli->user_id, ct, &mid) != 0) {
-                    fprintf(stderr, "ERROR: chat_repo_save_message failed\n");
-                    cJSON_Delete(req);
-                    free(f.payload);
-                    return;
-                }
-
-                // 같은 방에 접속 안 한 멤버에게만 unread 추가
-                {
-                    uint32_t *members; size_t mcnt;
-                    if (chat_repo_get_room_members(cli->room_id, &members, &mcnt) == 0) {
-                        bool *online = calloc(mcnt, sizeof(bool));
-                        pthread_mutex_lock(&clients_mtx);
-                        for (client_t *c = clients; c; c = c->next) {
-                            if (c->handshaked && c->room_id == cli->room_id) {
-                                for (size_t j = 0; j < mcnt; j++) {
-                                    if (members[j] == c->user_id) {
-                                        online[j] = true;
-                                        break;
-                                    }
-                                }
-                            }
-                        }
-                        pthread_mutex_unlock(&clients_mtx);
-                        for (size_t i = 0; i < mcnt; i++) {
-                            if (members[i] == cli->user_id) continue;
-                            if (online[i])            continue;
-                            chat_repo_add_unread(mid, members[i]);
-                        }
-                        free(online);
-                        free(members);
-                    }
-                }
-
-                notify_unread(cli->room_id, mid, cli->user_id);
-
-                uint32_t unread_cnt = 0;
-                chat_repo_count_message_unread(mid, &unread_cnt);
-
-                cJSON *res = cJSON_CreateObject();
-                cJSON_AddStringToObject(res, "type",       "message");
-                cJSON_AddNumberToObject(res, "room",       cli->room_id);
-                cJSON_AddNumberToObject(res, "id",         mid);
-                cJSON_AddNumberToObject(res, "sender",     cli->user_id);
-                {
-                    char *nick = session_repository_get_nick(cli->user_id);
-                    cJSON_AddStringToObject(res, "nick", nick);
-                    free(nick);
-                }
-                cJSON_AddStringToObject(res, "content",    ct);
-                cJSON_AddNumberToObject(res, "ts",         time(NULL));
-                cJSON_AddNumberToObject(res, "unread_cnt", unread_cnt);
-                broadcast_room(cli->room_id, res);
+            j->notes[j->nnotes].user_id = offline[i];
+            j->notes[j->nnotes].count   = ucnt;
+            j->nnotes++;
+        }
+    }
+
+    chat_repo_count_message_unread(j->mid, &j->unread_cnt);
+    if (!j->nick[0]) user_cache_nick(j->sender, j->nick, sizeof j->nick);
+}
+
+static void message_done(db_job_t *job) {
+    msg_job_t *j = (msg_job_t *) job;
+    client_t *cli = j->cli;
+
+    if (j->ok) {
+        notify_unread(j->room, j->notes, j->nnotes);
+
+        broadcast_room(j->room, ws_ev_message((uint32_t) j->room, j->mid, j->sender, j->nick,
+                                              j->content, j->content_len, time(NULL),
+                                              j->unread_cnt));
+    }
+
+    free(j->notes);
+    free(j->content);
+    free(j);
+    finish_job(cli);
+}
+
+// 저장 시작: 그룹 커밋 단계를 거치거나 바로 DB worker 로
+static void start_message(client_t *cli, msg_job_t *j) {
+    if (commit_batch) {
+        j->commit.room_id   = (uint32_t) j->room;
+        j->commit.sender_id = j->sender;
+        j->commit.content   = j->content;
+        j->commit.len       = j->content_len;
+        j->commit.done      = message_committed;
+        hold_for_job(cli, &j->job, message_work, message_done);
+        chat_commit_submit(&j->commit);
+    } else {
+        submit_job(cli, &j->job, message_work, message_done);
+    }
+}
+
+// ---- 세션 재검증 ----
+// 연결에 기록한 세션의 신뢰 기한이 지났으면 메시지를 저장하기 전에 다시 확인.
+// 폐기된 세션(로그아웃 등)은 여기서 걸러져 연결이 닫힌다
+typedef struct {
+    db_job_t   job;
+    client_t  *cli;
+    char       sid[65];
+    int        rc;
+    uint32_t   uid;
+    time_t     exp;
+    msg_job_t *msg;     // 확인되면 이어서 저장할 메시지
+} reauth_job_t;
+
+static void reauth_work(db_job_t *job) {
+    reauth_job_t *j = (reauth_job_t *) job;
+    j->rc = session_cache_find(j->sid, &j->uid, &j->exp);
+}
+
+static void reauth_done(db_job_t *job) {
+    reauth_job_t *j = (reauth_job_t *) job;
+    client_t *cli = j->cli;
+    msg_job_t *m = j->msg;
+    int ok = j->rc == 0 && j->uid == cli->user_id;
+
+    if (ok && !cli->closing) {
+        remember_session(cli, j->sid, j->exp);
+        // 수신을 재개하지 않고 바로 메시지 작업으로 넘겨 요청 순서 유지
+        start_message(cli, m);
+        free(j);
+        client_release(cli);
+        return;
+    }
+    if (j->rc < 0) {
+        fprintf(stderr, "ERROR: session recheck failed (DB) uid=%u, message dropped\n", cli->user_id);
+    } else if (!ok && !cli->closing) {
+        close_with(cli, WS_CLOSE_POLICY);
+    }
+    free(m->content);
+    free(m);
+    free(j);
+    finish_job(cli);
+}
+
+// -------------------------------------------------------
+// 디코드된 요청 처리. 문자열 필드는 호출자의 버퍼를 가리키므로 넘길 때 복사
+static void dispatch_request(client_t *cli, const ws_req_t *rq) {
+    switch (rq->type) {
+    case WS_REQ_AUTH: {
+        auth_job_t *j = calloc(1, sizeof *j);
+        if (j) {
+            j->cli = cli;
+            strncpy(j->sid, rq->sid, sizeof j->sid - 1);
+            submit_job(cli, &j->job, auth_work, auth_done);
+        }
+        break;
+    }
+    case WS_REQ_JOIN: {
+        join_job_t *j = calloc(1, sizeof *j);
+        if (j) {
+            j->cli  = cli;
+            j->room = rq->room;
+            strncpy(j->sid, rq->sid, sizeof j->sid - 1);
+            if (session_valid(cli, j->sid)) {
+                j->verified = 1;
+                j->uid      = cli->user_id;
             }
-            // update-chat-room
-            else if (strcmp(jt->valuestring, "update-chat-room") == 0) {
-                cJSON *res = cJSON_CreateObject();
-                cJSON_AddStringToObject(res, "type", "updated-chat-room");
-                broadcast_all(res);
+            submit_job(cli, &j->job, join_work, join_done);
+        }
+        break;
+    }
+    case WS_REQ_LEAVE: {
+        uint32_t rid = cli->room_id;
+        set_room(cli, 0);
+        broadcast_room(rid, ws_ev_left(rid, cli->user_id));
+        break;
+    }
+    case WS_REQ_MESSAGE: {
+        msg_job_t *j = calloc(1, sizeof *j);
+        if (j && (j->content = malloc(rq->content_len + 1))) {
+            memcpy(j->content, rq->content, rq->content_len + 1);
+            j->cli         = cli;
+            j->room        = cli->room_id;
+            j->sender      = cli->user_id;
+            j->content_len = rq->content_len;
+            memcpy(j->nick, cli->nick, sizeof j->nick);
+            reauth_job_t *r;
+            if (!cli->sid[0] || session_fresh(cli)) {
+                start_message(cli, j);
+            } else if ((r = calloc(1, sizeof *r))) {
+                r->cli = cli;
+                r->msg = j;
+                memcpy(r->sid, cli->sid, sizeof r->sid);
+                submit_job(cli, &r->job, reauth_work, reauth_done);
+            } else {
+                free(j->content);
+                free(j);
             }
+        } else {
+            free(j);
         }
-        cJSON_Delete(req);
-        free(f.payload);
-        return;
+        break;
+    }
+    case WS_REQ_UPDATE_ROOMS: {
+        broadcast_all(ws_ev_updated_chat_room());
+        break;
+    }
+    case WS_REQ_PONG:       // JSON heartbeat 응답: last_seen 갱신으로 충분
+    case WS_REQ_INVALID:    // 필요한 필드가 없는 요청은 무시
+    case WS_REQ_UNKNOWN:
+        break;
+    }
+}
+
+// -------------------------------------------------------
+// 완성된 메시지 또는 제어 프레임 하나 처리. cli 를 닫기로 했으면 -1
+// close 프레임을 보내고 종료
+static void close_with(client_t *cli, uint16_t code) {
+    ws_msg_t *m = ws_msg_close(code, NULL);
+    if (m) {
+        send_msg(cli, m);
+        ws_msg_unref(m);
+    }
+    close_later(cli);
+}
+
+static int handle_frame(client_t *cli, ws_frame_t f) {
+    // 어떤 프레임이든 받으면 살아 있는 것
+    cli->last_seen = ws_now_ms();
+
+    // 압축 메시지(RSV1): 협상된 연결만 허용 (제어 프레임/continuation 은 파서가 거절)
+    if (f.rsv1) {
+        if (!cli->deflate) {
+            ws_frame_free(&f);
+            close_with(cli, WS_CLOSE_PROTOCOL);
+            return -1;
+        }
+        uint8_t *plain;
+        size_t   plen;
+        int rc = ws_inflate(f.payload, f.len, ws_reader_max_message(), &plain, &plen);
+        ws_frame_free(&f);
+        if (rc != 0) {
+            close_with(cli, rc == -2 ? WS_CLOSE_TOO_BIG : WS_CLOSE_PROTOCOL);
+            return -1;
+        }
+        f.payload = plain;
+        f.owner   = WS_PAYLOAD_HEAP;
+        f.len     = plen;
+        f.rsv1    = 0;
+    }
+
+    // 제어 프레임은 JSON 까지 가지 않고 여기서 처리
+    switch (f.opcode) {
+    case WS_OP_CLOSE: {
+        // 받은 상태 코드를 그대로 돌려주고 종료 (없으면 빈 close).
+        // 1바이트 payload 나 보내면 안 되는 코드에는 1002
+        uint16_t code = 0;
+        if (f.len == 1) {
+            code = WS_CLOSE_PROTOCOL;
+        } else if (f.len >= 2) {
+            code = (uint16_t) (f.payload[0] << 8 | f.payload[1]);
+            if (!ws_close_code_valid(code)) code = WS_CLOSE_PROTOCOL;
+        }
+        ws_frame_free(&f);
+        close_with(cli, code);
+        return -1;
+    }
+    case WS_OP_PING: {
+        ws_msg_t *m = ws_msg_control(WS_OP_PONG, f.payload, f.len);
+        if (m) {
+            send_msg(cli, m);
+            ws_msg_unref(m);
+        }
+        ws_frame_free(&f);
+        return 0;
+    }
+    case WS_OP_PONG:
+        ws_frame_free(&f);
+        return 0;
+    }
+
+    // 3) 요청 디코드: 빠른 경로가 안 되는 모양만 cJSON 으로
+    ws_req_t rq;
+    if (ws_req_decode((char *) f.payload, f.len, &rq)) {
+        dispatch_request(cli, &rq);
+        ws_frame_free(&f);
+        return 0;
+    }
+    cJSON *req = ws_req_parse((char*)f.payload, f.len);
+    if (req) {
+        ws_req_from_json(req, &rq);
+        dispatch_request(cli, &rq);
+        ws_req_parse_done(req);
+        ws_frame_free(&f);
+        return 0;
     }
 
     // JSON 아니면 echo
     {
-        uint8_t buf[2048];
-        size_t bl = ws_build_text_frame(f.payload, f.len, buf);
-        writen(fd, buf, bl);
+        ws_msg_t *m = ws_msg_text(f.payload, f.len);
+        if (m) {
+            send_msg(cli, m);
+            ws_msg_unref(m);
+        }
+    }
+    ws_frame_free(&f);
+    return 0;
+}
+
+// -------------------------------------------------------
+// heartbeat: 연결마다 타이머 하나가 "ping 보낼 때" 와 "pong 기다릴 때" 를 번갈아 걸림.
+// 수신은 last_seen 만 갱신하므로 타이머를 다시 걸 필요가 없다.
+static void on_client_timer(ws_timer_t *t);
+
+static void send_ping(client_t *cli, uint64_t now) {
+    send_msg(cli, self->ping_msg);
+    cli->ping_at   = now;
+    cli->ping_wait = 1;
+    ws_timer_arm(&self->wheel, &cli->timer, now + PONG_TIMEOUT * 1000, on_client_timer);
+}
+
+static void on_client_timer(ws_timer_t *t) {
+    client_t *cli = TIMER_CLIENT(t);
+    if (cli->closing) return;
+
+    // 업그레이드 요청 미완성
+    if (!cli->handshaked) {
+        close_later(cli);
+        return;
+    }
+
+    uint64_t now = ws_now_ms();
+    if (cli->ping_wait) {
+        if (cli->last_seen < cli->ping_at) {   // ping 이후 아무것도 안 옴
+            close_later(cli);
+            return;
+        }
+        // 다음 ping 은 지난 ping 기준으로 (연결별 간격 유지)
+        cli->ping_wait = 0;
+        uint64_t next = cli->ping_at + PING_INTERVAL * 1000;
+        if (next > now) {
+            ws_timer_arm(&self->wheel, &cli->timer, next, on_client_timer);
+            return;
+        }
+    }
+    send_ping(cli, now);
+}
+
+// 핸드셰이크 완료 후 첫 ping 시각은 간격 안에서 fd 로 흩어 한꺼번에 몰리지 않게
+static void start_heartbeat(client_t *cli) {
+    uint64_t now    = ws_now_ms();
+    uint64_t spread = ((uint32_t) cli->fd * 2654435761u) % (PING_INTERVAL * 1000);
+    cli->last_seen = now;
+    cli->ping_wait = 0;
+    ws_timer_arm(&self->wheel, &cli->timer, now + spread, on_client_timer);
+}
+
+// -------------------------------------------------------
+static void handle_client(client_t *cli) {
+    int fd = cli->fd;
+
+    // 1) WebSocket 핸드셰이크 (요청이 완성될 때까지 wakeup 마다 누적)
+    if (!cli->handshaked) {
+        char   res[512];
+        size_t res_len = 0;
+        int rc = websocket_handshake(&cli->hs, fd, res, sizeof res, &res_len);
+        if (rc == 0) return;
+        if (rc < 0) {
+            close_later(cli);
+            return;
+        }
+        ws_msg_t *m = ws_msg_raw(res, res_len);
+        if (!m) {
+            close_later(cli);
+            return;
+        }
+        send_msg(cli, m);
+        ws_msg_unref(m);
+
+        cli->deflate = cli->hs.deflate;
+
+        // 요청 뒤에 이어 붙어 온 바이트는 프레임 파서로 넘김
+        rc = ws_reader_feed(&cli->rd, cli->hs.buf + cli->hs.hdr_len,
+                            cli->hs.len - cli->hs.hdr_len);
+        ws_handshake_free(&cli->hs);
+        if (rc < 0 || cli->closing) {
+            close_later(cli);
+            return;
+        }
+        cli->handshaked = 1;
+        ws_conn_hot_t *h = ws_conntab_get(&self->conns, fd);
+        if (h) h->state |= WS_CONN_READY;
+        cli->user_id    = 0;
+        cli->room_id    = 0;
+        start_heartbeat(cli);
+    }
+
+    // 2) 버퍼에 완성된 프레임을 모두 처리하고, 읽을 수 있는 만큼 더 읽음
+    //    DB 작업이 걸리면 멈췄다가 완료 콜백에서 이어서 처리
+    for (;;) {
+        ws_frame_t f;
+        int r = 0;
+        while (!cli->inflight && (r = ws_reader_next(&cli->rd, &f)) > 0) {
+            if (handle_frame(cli, f) < 0 || cli->closing) return;
+        }
+        if (cli->inflight) return;
+        if (r < 0) {
+            close_with(cli, cli->rd.err ? cli->rd.err : WS_CLOSE_PROTOCOL);
+            return;
+        }
+
+        ssize_t n = ws_reader_fill(&cli->rd, fd);
+        if (n < 0) {
+            close_later(cli);
+            return;
+        }
+        if (n == 0) return;   // EAGAIN: 다음 epoll 알림까지 대기
     }
-    free(f.payload);
-    return;
+}
+
+// -------------------------------------------------------
+// SIGUSR1: reactor 별 송신 큐 상태 덤프 (low 워터마크 이상 밀린 연결 표시)
+static void on_sigusr1(int sig) {
+    (void) sig;
+    stats_gen++;
+}
+
+static void dump_stats(void) {
+    size_t lagging = 0, queued = 0;
+    for (size_t i = 0; i < self->conns.n; i++) {
+        client_t *c = self->conns.hot[i].obj;
+        queued += c->out.bytes;
+        if (c->out.bytes > outq_low_wm) {
+            lagging++;
+            fprintf(stderr, "  [r%d] lagging fd=%d uid=%u room=%d queued=%zu frames=%zu peak=%zu dropped=%lu\n",
+                    self->id, c->fd, c->user_id, c->room_id, c->out.bytes, c->out.frames,
+                    c->out.peak, (unsigned long) c->out.dropped);
+        }
+    }
+    fprintf(stderr, "STATS[r%d]: conns=%zu lagging=%zu queued_bytes=%zu mailbox_posted=%lu db_pending=%zu timers=%zu\n",
+            self->id, self->conns.n, lagging, queued, self->mbox.posted, db_pool_pending(),
+            self->wheel.pending);
+
+    // 수신 버퍼 풀 (reactor 스레드별)
+    ws_bufpool_stats_t bs;
+    ws_bufpool_stats(&bs);
+    fprintf(stderr, "STATS[r%d/rxbuf]: inplace=%lu hits=%lu misses=%lu in_use=%zu peak=%zu cached=%zu\n",
+            self->id, ws_reader_inplace_frames(), bs.hits, bs.misses, bs.in_use, bs.peak, bs.cached);
+
+    ws_req_json_stats_t js;
+    ws_req_json_stats(&js);
+    fprintf(stderr, "STATS[r%d/json]: fallback=%lu heap=%lu spills=%lu arena_peak=%zu\n",
+            self->id, js.parses, js.heap, js.spills, js.peak);
+
+    // 전역 캐시/통계는 한 번만
+    if (self->id == 0) {
+        ws_deflate_stats_t ds;
+        ws_deflate_stats(&ds);
+        fprintf(stderr, "STATS[deflate]: frames=%lu in=%lu out=%lu ratio=%.2f\n",
+                ds.frames, ds.in_bytes, ds.out_bytes,
+                ds.in_bytes ? (double) ds.out_bytes / (double) ds.in_bytes : 0.0);
+
+        user_cache_stats_t us;
+        user_cache_stats(&us);
+        unsigned long lookups = us.hits + us.misses;
+        fprintf(stderr, "STATS[nick]: entries=%zu bytes=%zu hits=%lu misses=%lu hit_rate=%.1f%% evictions=%lu\n",
+                us.entries, us.bytes, us.hits, us.misses,
+                lookups ? 100.0 * (double) us.hits / (double) lookups : 0.0, us.evictions);
+
+        if (commit_batch) {
+            chat_commit_stats_t cs;
+            chat_commit_stats(&cs);
+            char hist[CHAT_COMMIT_HIST * 24];
+            size_t hl = 0;
+            hist[0] = '\0';
+            for (int b = 0; b < CHAT_COMMIT_HIST && hl < sizeof hist; b++) {
+                if (!cs.hist[b]) continue;
+                hl += (size_t) snprintf(hist + hl, sizeof hist - hl, " %d:%lu", 1 << b, cs.hist[b]);
+            }
+            fprintf(stderr, "STATS[commit]: batches=%lu msgs=%lu avg_batch=%.1f max_batch=%zu failed=%lu retried=%lu avg_commit_us=%.0f hist=[%s ]\n",
+                    cs.batches, cs.messages,
+                    cs.batches ? (double) cs.messages / (double) cs.batches : 0.0,
+                    cs.max_batch, cs.failed, cs.retried,
+                    cs.batches ? (double) cs.commit_us / (double) cs.batches : 0.0, hist);
+        }
+    }
+}
+
+// -------------------------------------------------------
+// reactor 초기화 / 이벤트 루프
+static int reactor_init(reactor_t *r, int id) {
+    memset(r, 0, sizeof *r);
+    r->id        = id;
+    r->listen_fd = tcp_listen(PORT);
+    r->epoll_fd  = epoll_create1(0);
+    if (r->listen_fd < 0 || r->epoll_fd < 0) return -1;
+    if (ws_mailbox_init(&r->mbox) < 0)       return -1;
+    ws_wheel_init(&r->wheel, ws_now_ms());
+    ws_slab_init(&r->client_pool, sizeof(client_t), CLIENT_POOL_PAGE);
+    make_nonblock(r->listen_fd);
+
+    // listen 소켓과 mailbox 는 연결 키와 겹치지 않는 예약 키로 식별
+    struct epoll_event lev = { .events = EPOLLIN, .data.u64 = EV_LISTEN };
+    struct epoll_event mev = { .events = EPOLLIN, .data.u64 = EV_MAILBOX };
+    epoll_ctl(r->epoll_fd, EPOLL_CTL_ADD, r->listen_fd, &lev);
+    epoll_ctl(r->epoll_fd, EPOLL_CTL_ADD, r->mbox.efd,  &mev);
+    return 0;
+}
+
+static void accept_clients(void) {
+    for (;;) {
+        int cfd = accept(self->listen_fd, NULL, NULL);
+        if (cfd < 0) return;   // EAGAIN: 대기 중인 연결 없음
+        make_nonblock(cfd);
+        client_t *cli = ws_slab_alloc(&self->client_pool);
+        if (!cli) {
+            close(cfd);
+            continue;
+        }
+        if (ws_conntab_add(&self->conns, cfd, cli, &cli->key) < 0) {
+            ws_slab_free(&self->client_pool, cli);
+            close(cfd);
+            continue;
+        }
+        cli->fd         = cfd;
+        cli->handshaked = 0;
+        cli->last_seen  = ws_now_ms();
+        // 업그레이드 요청이 이 안에 완성되지 않으면 종료
+        ws_timer_arm(&self->wheel, &cli->timer, cli->last_seen + WS_HS_TIMEOUT * 1000, on_client_timer);
+        struct epoll_event cev = { .events = EPOLLIN, .data.u64 = cli->key };
+        epoll_ctl(self->epoll_fd, EPOLL_CTL_ADD, cfd, &cev);
+    }
+}
+
+static void *reactor_main(void *arg) {
+    self = arg;
+
+    struct epoll_event events[MAX_EVENTS];
+
+    // ping 프레임: 기본은 미리 만들어 둔 0x9 제어 프레임, 호환 모드는 JSON 을 reactor 마다 한 번
+    if (json_heartbeat) {
+        self->ping_msg = ws_ev_ping();
+    } else {
+        ws_msg_t *p = ws_msg_ping();
+        self->ping_msg = p ? ws_msg_ref(p) : NULL;
+    }
+    if (!self->ping_msg) {
+        fprintf(stderr, "ERROR: ping frame alloc failed (reactor %d)\n", self->id);
+        exit(EXIT_FAILURE);
+    }
+
+    // 요청 처리 중 cJSON 할당은 이 reactor 의 arena 에서 (없으면 힙)
+    if (json_arena_size && ws_arena_init(&self->json_arena, json_arena_size) == 0) {
+        ws_req_json_arena(&self->json_arena);
+    }
+
+    while (1) {
+        int timeout = ws_wheel_timeout(&self->wheel, ws_now_ms(), LOOP_WAIT_MS);
+        int n = epoll_wait(self->epoll_fd, events, MAX_EVENTS, timeout);
+        if (n < 0 && errno == EINTR) continue;
+
+        for (int i = 0; i < n; i++) {
+            uint64_t key = events[i].data.u64;
+            if (key == EV_LISTEN) {
+                accept_clients();
+            } else if (key == EV_MAILBOX) {
+                ws_mailbox_drain(&self->mbox);
+            } else {
+                // 이미 닫혀 fd 가 다른 연결에 재사용됐다면 세대가 달라 걸러짐
+                ws_conn_hot_t *h = ws_conntab_lookup(&self->conns, key);
+                if (!h) continue;
+                client_t *cli = h->obj;
+                uint32_t  evs = events[i].events;
+                if (cli->closing) continue;
+                if (evs & EPOLLOUT) flush_client(cli);
+                if (cli->closing)   continue;
+                if (evs & (EPOLLIN | EPOLLERR | EPOLLHUP)) handle_client(cli);
+            }
+        }
+
+        // 만료된 타이머만 처리 (ping 전송, pong/핸드셰이크 제한 초과 종료)
+        ws_wheel_advance(&self->wheel, ws_now_ms());
+
+        // 이번 루프에서 닫힌 연결 정리 (epoll, 소켓, 리스트, 메모리)
+        reap_closed();
+
+        if (self->stats_seen != (unsigned) stats_gen) {
+            self->stats_seen = (unsigned) stats_gen;
+            dump_stats();
+        }
+    }
+
+    return NULL;
 }
 
 int main() {
@@ -390,86 +1208,98 @@ int main() {
         fprintf(stderr, "ERROR: db_global_init failed\n");
         return EXIT_FAILURE;
     }
-    if (db_thread_init() != 0) {
-        fprintf(stderr, "ERROR: db_thread_init failed\n");
+
+    // 송신 큐 워터마크 / 느린 소비자 정책
+    outq_high_wm = (size_t) env_long("WS_OUTQ_HIGH", OUTQ_HIGH_WM);
+    outq_low_wm  = (size_t) env_long("WS_OUTQ_LOW",  OUTQ_LOW_WM);
+    if (outq_low_wm > outq_high_wm) outq_low_wm = outq_high_wm;
+    {
+        const char *pol = getenv("WS_SLOW_POLICY");   // "drop" | "disconnect"
+        slow_disconnect = !(pol && strcmp(pol, "drop") == 0);
+    }
+    // permessage-deflate: WS_DEFLATE=0 이면 협상 안 함, 최소 크기/압축 레벨
+    ws_handshake_config(env_long("WS_DEFLATE", 1) != 0);
+    ws_deflate_config((int) env_long("WS_DEFLATE_MIN", 0), (int) env_long("WS_DEFLATE_LEVEL", 0));
+    // 수신 메시지 최대 크기 (조각 조립/압축 해제 후 기준)
+    ws_reader_config((size_t) env_long("WS_MAX_MESSAGE", 0));
+    // cJSON 폴백 파서 arena 크기 (0 이면 arena 없이 힙)
+    json_arena_size = (size_t) env_long("WS_JSON_ARENA", JSON_ARENA_SIZE);
+    ws_req_json_init();
+    {
+        const char *rm = getenv("WS_RECEIPTS");       // "both" (기본) | "batch" | "legacy"
+        if (rm && strcmp(rm, "legacy") == 0)     receipt_mode = RECEIPTS_LEGACY;
+        else if (rm && strcmp(rm, "batch") == 0) receipt_mode = RECEIPTS_BATCH;
+    }
+    {
+        const char *hb = getenv("WS_HEARTBEAT");      // "native" | "json"
+        json_heartbeat = hb && strcmp(hb, "json") == 0;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGUSR1, on_sigusr1);
+
+    // reactor 수: 기본은 온라인 코어 수
+    nreactors = (int) env_long("WS_REACTORS", sysconf(_SC_NPROCESSORS_ONLN));
+    if (nreactors < 1)            nreactors = 1;
+    if (nreactors > MAX_REACTORS) nreactors = MAX_REACTORS;
+
+    reactors = calloc((size_t) nreactors, sizeof *reactors);
+    if (!reactors) {
         db_global_end();
         return EXIT_FAILURE;
     }
+    for (int i = 0; i < nreactors; i++) {
+        if (reactor_init(&reactors[i], i) != 0) {
+            fprintf(stderr, "ERROR: reactor_init failed (reactor %d)\n", i);
+            db_global_end();
+            return EXIT_FAILURE;
+        }
+    }
 
-    // listen + epoll
-    int lfd = tcp_listen(PORT);
-    epoll_fd = epoll_create1(0);
-    struct epoll_event ev = { .events = EPOLLIN, .data.fd = lfd };
-    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, lfd, &ev);
+    // 닉네임 캐시: 최대 항목 수 / 유효 시간(초)
+    user_cache_init(env_long("WS_NICK_CACHE", 0), (int) env_long("WS_NICK_TTL", 0));
 
-    printf("Listening on :%d\n", PORT);
+    // 세션 캐시: 최대 항목 수 / 만료 없는 세션 유효 시간 / 없는 sid 음성 캐시 시간(초)
+    session_cache_init(env_long("WS_SID_CACHE", 0), (int) env_long("WS_SID_TTL", 0),
+                       (int) env_long("WS_SID_NEG_TTL", 0));
 
-    struct epoll_event events[MAX_EVENTS];
-    time_t last_ping = time(NULL);
+    // 방 멤버 캐시: 최대 방 수 / 스냅샷 유효 시간(초). 멤버십은 HTTP API 쪽에서도 바뀜
+    room_members_init(env_long("WS_ROOM_CACHE", 0), (int) env_long("WS_ROOM_TTL", 0));
 
-    while (1) {
-        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, 1000);
-        if (n < 0 && errno == EINTR) continue;
+    // unread 개수 캐시: 이 주기마다 DB 값으로 다시 맞춤
+    chat_unread_cache_init((int) env_long("WS_UNREAD_RECONCILE", 0));
 
-        for (int i = 0; i < n; i++) {
-            if (events[i].data.fd == lfd) {
-                int cfd = accept(lfd, NULL, NULL);
-                make_nonblock(cfd);
-                client_t *cli = calloc(1, sizeof(*cli));
-                cli->fd         = cfd;
-                cli->handshaked = 0;
-                cli->last_pong  = time(NULL);
-                pthread_mutex_lock(&clients_mtx);
-                cli->next = clients;
-                clients   = cli;
-                pthread_mutex_unlock(&clients_mtx);
-                struct epoll_event cev = { .events = EPOLLIN, .data.ptr = cli };
-                epoll_ctl(epoll_fd, EPOLL_CTL_ADD, cfd, &cev);
-            } else {
-                client_t *cli = events[i].data.ptr;
-                handle_client(cli);
-            }
-        }
+    // DB worker 풀: reactor 는 MySQL 을 직접 호출하지 않음
+    int db_workers = (int) env_long("WS_DB_WORKERS", DB_WORKERS);
+    if (db_workers < 1) db_workers = 1;
+    if (db_pool_start(db_workers) != 0) {
+        fprintf(stderr, "ERROR: db_pool_start failed\n");
+        db_global_end();
+        return EXIT_FAILURE;
+    }
 
-        time_t now = time(NULL);
+    // 메시지 그룹 커밋: 최대 배치 수 / 첫 메시지 후 최대 대기(us). 배치 0 이면 끔
+    commit_batch = (size_t) env_long("WS_COMMIT_BATCH", COMMIT_BATCH);
+    if (commit_batch > CHAT_COMMIT_BATCH_MAX) commit_batch = CHAT_COMMIT_BATCH_MAX;
+    if (commit_batch &&
+        chat_commit_start(commit_batch, env_long("WS_COMMIT_WINDOW_US", COMMIT_WINDOW_US)) != 0) {
+        fprintf(stderr, "ERROR: chat_commit_start failed\n");
+        db_pool_stop();
+        db_global_end();
+        return EXIT_FAILURE;
+    }
 
-        // 1) app-level ping 전송
-        if (now - last_ping >= PING_INTERVAL) {
-            pthread_mutex_lock(&clients_mtx);
-            for (client_t *c = clients; c; c = c->next) {
-                if (c->handshaked) {
-                    cJSON *ping = cJSON_CreateObject();
-                    cJSON_AddStringToObject(ping, "type", "ping");
-                    send_json(c, ping);
-                }
-            }
-            pthread_mutex_unlock(&clients_mtx);
-            last_ping = now;
-        }
-
-        {
-            pthread_mutex_lock(&clients_mtx);
-
-            client_t **p = &clients;
-            while (*p) {
-                client_t *c = *p;
-                if (c->handshaked && (now - c->last_pong) > PONG_TIMEOUT) {
-                    // 1) epoll, 소켓, 리스트, 메모리까지 완전히 정리
-                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
-                    close(c->fd);
-                    *p = c->next;
-                    free(c);
-                } else {
-                    // 삭제하지 않은 경우에만 다음으로 이동
-                    p = &c->next;
-                }
-            }
+    printf("Listening on :%d (%d reactors, %d db workers)\n", PORT, nreactors, db_workers);
 
-            pthread_mutex_unlock(&clients_mtx);
-        }
+    // 모든 reactor 가 준비된 뒤에 스레드 시작 (mailbox 교차 참조)
+    for (int i = 0; i < nreactors; i++) {
+        pthread_create(&reactors[i].tid, NULL, reactor_main, &reactors[i]);
+    }
+    for (int i = 0; i < nreactors; i++) {
+        pthread_join(reactors[i].tid, NULL);
     }
 
-    db_thread_cleanup();
+    chat_commit_stop();
+    db_pool_stop();
     db_global_end();
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,57 @@
+#include "ws_slab.h"
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SLAB_ALIGN alignof(max_align_t)
+
+// 페이지 = [다음 페이지 포인터 (정렬 맞춤)][칸 × per_page]
+#define PAGE_HDR SLAB_ALIGN
+
+void ws_slab_init(ws_slab_t *s, size_t obj_size, size_t per_page) {
+    memset(s, 0, sizeof *s);
+    if (obj_size < sizeof(void *)) obj_size = sizeof(void *);
+    s->obj_size = (obj_size + SLAB_ALIGN - 1) & ~(SLAB_ALIGN - 1);
+    s->per_page = per_page ? per_page : 64;
+}
+
+static int grow(ws_slab_t *s) {
+    char *page = malloc(PAGE_HDR + s->obj_size * s->per_page);
+    if (!page) return -1;
+    *(void **) page = s->pages;
+    s->pages = page;
+
+    // 낮은 주소부터 나가도록 뒤에서부터 free list 에 넣음
+    for (size_t i = s->per_page; i-- > 0;) {
+        void *obj = page + PAGE_HDR + i * s->obj_size;
+        *(void **) obj = s->free;
+        s->free = obj;
+    }
+    s->total += s->per_page;
+    return 0;
+}
+
+void *ws_slab_alloc(ws_slab_t *s) {
+    if (!s->free && grow(s) < 0) return NULL;
+    void *obj = s->free;
+    s->free = *(void **) obj;
+    s->live++;
+    memset(obj, 0, s->obj_size);
+    return obj;
+}
+
+void ws_slab_free(ws_slab_t *s, void *p) {
+    if (!p) return;
+    *(void **) p = s->free;
+    s->free = p;
+    s->live--;
+}
+
+void ws_slab_destroy(ws_slab_t *s) {
+    while (s->pages) {
+        void *next = *(void **) s->pages;
+        free(s->pages);
+        s->pages = next;
+    }
+    memset(s, 0, sizeof *s);
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <stddef.h>
+
+/* ---------- 고정 크기 객체 풀 (reactor 전용, 잠금 없음) ----------
+ * 페이지 단위로 한꺼번에 잡아 두고 빈 칸을 free list 로 돌려 쓴다.
+ * 할당/해제 O(1), 같은 페이지 객체끼리 메모리상 가까이 놓인다.
+ * 페이지는 풀을 없앨 때까지 반환하지 않는다 (최대 동시 연결 수만큼 유지). */
+
+typedef struct {
+    size_t obj_size;    /* 정렬을 맞춘 칸 크기 */
+    size_t per_page;
+    void  *free;        /* 빈 칸 연결 리스트 (칸 앞 포인터 하나를 링크로 사용) */
+    void  *pages;       /* 페이지 연결 리스트 */
+    size_t live;        /* 사용 중인 칸 */
+    size_t total;       /* 전체 칸 */
+} ws_slab_t;
+
+void  ws_slab_init(ws_slab_t *s, size_t obj_size, size_t per_page);
+void *ws_slab_alloc(ws_slab_t *s);          /* 0 으로 채워진 칸, 메모리 부족이면 NULL */
+void  ws_slab_free(ws_slab_t *s, void *p);
+void  ws_slab_destroy(ws_slab_t *s);
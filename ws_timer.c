@@ -0,0 +1,119 @@
+#include "ws_timer.h"
+#include <string.h>
+
+#define L0_SIZE  (1u << WS_TW_L0_BITS)
+#define LN_SIZE  (1u << WS_TW_LN_BITS)
+#define L0_MASK  (L0_SIZE - 1)
+#define LN_MASK  (LN_SIZE - 1)
+
+/* n 단계 휠이 담당하는 비트 시작 위치 (n = 0 → L1) */
+#define LN_SHIFT(n)  (WS_TW_L0_BITS + (n) * WS_TW_LN_BITS)
+#define MAX_DELTA    ((1ull << LN_SHIFT(WS_TW_LEVELS - 1)) - 1)
+
+void ws_wheel_init(ws_wheel_t *w, uint64_t now_ms) {
+    memset(w, 0, sizeof *w);
+    w->tick = now_ms / WS_TW_TICK_MS;
+}
+
+static void link(ws_timer_t **head, ws_timer_t *t) {
+    t->next  = *head;
+    t->pprev = head;
+    if (*head) (*head)->pprev = &t->next;
+    *head = t;
+}
+
+static void unlink_timer(ws_timer_t *t) {
+    *t->pprev = t->next;
+    if (t->next) t->next->pprev = t->pprev;
+    t->next  = NULL;
+    t->pprev = NULL;
+}
+
+// expires 까지 남은 tick 수에 맞는 칸에 넣음
+static void place(ws_wheel_t *w, ws_timer_t *t) {
+    uint64_t exp = t->expires;
+    if (exp < w->tick) exp = w->tick;               // 이미 지남: 다음 처리 tick
+    uint64_t delta = exp - w->tick;
+
+    if (delta < L0_SIZE) {
+        link(&w->l0[exp & L0_MASK], t);
+        return;
+    }
+    if (delta > MAX_DELTA) {                         // 너무 먼 미래: 가장 바깥 칸에서 재분배
+        exp = w->tick + MAX_DELTA;
+        t->expires = exp;
+    }
+    for (int n = 0; n < WS_TW_LEVELS - 1; n++) {
+        if (delta < (1ull << LN_SHIFT(n + 1)) || n == WS_TW_LEVELS - 2) {
+            link(&w->ln[n][(exp >> LN_SHIFT(n)) & LN_MASK], t);
+            return;
+        }
+    }
+}
+
+void ws_timer_arm(ws_wheel_t *w, ws_timer_t *t, uint64_t at_ms, ws_timer_fn fn) {
+    if (t->pprev) unlink_timer(t);
+    else          w->pending++;
+    t->fn      = fn;
+    t->expires = (at_ms + WS_TW_TICK_MS - 1) / WS_TW_TICK_MS;   // 일찍 만료되지 않게 올림
+    place(w, t);
+}
+
+void ws_timer_cancel(ws_wheel_t *w, ws_timer_t *t) {
+    if (!t->pprev) return;
+    unlink_timer(t);
+    w->pending--;
+}
+
+// 상위 휠 한 칸을 비워 아래 단계로 재분배. 칸 번호를 돌려줌 (0 이면 더 위도 내려야 함)
+static unsigned cascade(ws_wheel_t *w, int n) {
+    unsigned idx = (unsigned) ((w->tick >> LN_SHIFT(n)) & LN_MASK);
+    ws_timer_t *list = w->ln[n][idx];
+    w->ln[n][idx] = NULL;
+    while (list) {
+        ws_timer_t *t = list;
+        list = t->next;
+        t->next  = NULL;
+        t->pprev = NULL;
+        place(w, t);
+    }
+    return idx;
+}
+
+void ws_wheel_advance(ws_wheel_t *w, uint64_t now_ms) {
+    uint64_t target = now_ms / WS_TW_TICK_MS;
+    while (w->tick <= target) {
+        // L0 한 바퀴가 돌 때마다 위 단계 칸을 내림
+        if ((w->tick & L0_MASK) == 0) {
+            for (int n = 0; n < WS_TW_LEVELS - 1 && cascade(w, n) == 0; n++) {}
+        }
+
+        // 이 tick 의 목록을 떼어 낸 뒤 실행 (콜백에서 재등록해도 안전)
+        ws_timer_t *list = w->l0[w->tick & L0_MASK];
+        w->l0[w->tick & L0_MASK] = NULL;
+        if (list) list->pprev = &list;
+        w->tick++;
+
+        while (list) {
+            ws_timer_t *t = list;
+            unlink_timer(t);
+            w->pending--;
+            t->fn(t);
+        }
+    }
+}
+
+int ws_wheel_timeout(const ws_wheel_t *w, uint64_t now_ms, int max_ms) {
+    if (w->pending == 0) return max_ms;
+
+    // L0 에서 가장 가까운 칸, 없으면 다음 재분배 시점까지
+    // (tick 이 경계에 있으면 재분배 전이라 L0 가 비어 보일 수 있음)
+    uint64_t t = w->tick;
+    uint64_t end = (t & L0_MASK) == 0 ? t : (t | L0_MASK) + 1;
+    while (t < end && !w->l0[t & L0_MASK]) t++;
+
+    uint64_t at = t * WS_TW_TICK_MS;
+    if (at <= now_ms) return 0;
+    uint64_t ms = at - now_ms;
+    return ms < (uint64_t) max_ms ? (int) ms : max_ms;
+}
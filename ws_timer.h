@@ -0,0 +1,44 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/* ---------- 계층형 타이머 휠 (reactor 전용, 잠금 없음) ----------
+ * 시각은 단조 시계 ms. tick = WS_TW_TICK_MS, 4 단계 휠:
+ *   L0 256 칸 × 10ms ≈ 2.5초, L1 64 칸 ≈ 164초, L2 64 칸 ≈ 2.9시간, L3 64 칸 ≈ 7.7일
+ * 등록/재등록/취소는 O(1), 만료 처리는 지난 tick 수 + 만료된 타이머 수에 비례. */
+
+#define WS_TW_TICK_MS  10
+#define WS_TW_L0_BITS  8
+#define WS_TW_LN_BITS  6
+#define WS_TW_LEVELS   4
+
+typedef struct ws_timer ws_timer_t;
+typedef void (*ws_timer_fn)(ws_timer_t *t);
+
+struct ws_timer {
+    ws_timer_t  *next;
+    ws_timer_t **pprev;      /* NULL 이면 등록 안 됨 */
+    uint64_t     expires;    /* tick 단위 */
+    ws_timer_fn  fn;         /* 만료 시 호출 (이미 해제된 상태로, 다시 arm 가능) */
+};
+
+typedef struct {
+    uint64_t    tick;        /* 다음에 처리할 tick (이전 tick 은 모두 처리됨) */
+    size_t      pending;     /* 등록된 타이머 수 */
+    ws_timer_t *l0[1 << WS_TW_L0_BITS];
+    ws_timer_t *ln[WS_TW_LEVELS - 1][1 << WS_TW_LN_BITS];
+} ws_wheel_t;
+
+void ws_wheel_init(ws_wheel_t *w, uint64_t now_ms);
+
+/* at_ms 에 만료되도록 등록. 이미 등록돼 있으면 옮김. 지난 시각이면 다음 처리 때 만료 */
+void ws_timer_arm(ws_wheel_t *w, ws_timer_t *t, uint64_t at_ms, ws_timer_fn fn);
+void ws_timer_cancel(ws_wheel_t *w, ws_timer_t *t);
+
+static inline int ws_timer_armed(const ws_timer_t *t) { return t->pprev != NULL; }
+
+/* now_ms 까지 만료된 타이머 콜백 실행 */
+void ws_wheel_advance(ws_wheel_t *w, uint64_t now_ms);
+
+/* 다음 만료까지 남은 ms (epoll_wait 타임아웃용, max_ms 이하) */
+int  ws_wheel_timeout(const ws_wheel_t *w, uint64_t now_ms, int max_ms);
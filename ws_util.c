@@ -1,5 +1,7 @@
 #include "ws_util.h"
 #include <errno.h>
+#include <stdlib.h>
+#include <time.h>
 
 ssize_t readn(int fd, void *buf, size_t n) {
     size_t left = n; char *p = buf;
@@ -21,3 +23,17 @@ ssize_t writen(int fd, const void *buf, size_t n) {
     }
     return n;
 }
+
+long env_long(const char *name, long def) {
+    const char *v = getenv(name);
+    if (!v || !*v) return def;
+    char *end;
+    long n = strtol(v, &end, 10);
+    return (*end == '\0' && n >= 0) ? n : def;
+}
+
+uint64_t ws_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000;
+}
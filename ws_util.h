@@ -2,4 +2,10 @@
 #include <stdint.h>
 #include <unistd.h>
 ssize_t readn(int fd, void *buf, size_t n);
-ssize_t writen(int fd, const void *buf, size_t n);
\ No newline at end of file
+ssize_t writen(int fd, const void *buf, size_t n);
+
+/* 환경변수 정수 값 (없거나 잘못되면 def) */
+long env_long(const char *name, long def);
+
+/* 단조 시계 (ms). 벽시계 변경에 영향받지 않는 타이머/생존 확인용 */
+uint64_t ws_now_ms(void);